@@ -0,0 +1,1569 @@
+// Standalone benchmark for the boost path in matrix_operations. No raylib needed:
+//   g++ -std=c++17 -O2 -pthread boost_bench.cpp matrix_operations.cpp boost_kernels.cpp event_pipeline.cpp event_store.cpp capture_writer.cpp frame_arena.cpp worldline.cpp sim_clock.cpp worker_pool.cpp -o boost_bench
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include "matrix_operations.h"
+#include "boost_kernels.h"
+#include "event_pipeline.h"
+#include "capture_writer.h"
+#include "worldline.h"
+#include "sim_clock.h"
+#include "worker_pool.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+static double secondsSince(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+// Checks whose failure makes main return nonzero
+static int failures = 0;
+
+// Random velocities with speed below max_speed, like the observer slider produces
+static std::vector<float> randomVelocities(int count, float max_speed) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> velocities;
+    velocities.reserve(count * 3);
+    while ((int)velocities.size() < count * 3) {
+        float v[3] = {dist(rng), dist(rng), dist(rng)};
+        float speed = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (speed == 0 || speed >= 1) continue;
+        float scale = max_speed * dist(rng) / speed;
+        velocities.insert(velocities.end(), {v[0] * scale, v[1] * scale, v[2] * scale});
+    }
+    return velocities;
+}
+
+// getFinalMat4 (rotate, boost, rotate back) against the closed-form getBoostMat4
+static void benchBoostBuilders() {
+    const int count = 1 << 16;
+    const int repeats = 20;
+    std::vector<float> velocities = randomVelocities(count, 0.99f);
+
+    float max_error = 0;
+    for (int i = 0; i < count; i++) {
+        Mat4 a, b;
+        getFinalMat4(&velocities[i * 3], a);
+        getBoostMat4(&velocities[i * 3], b);
+        for (int k = 0; k < 16; k++) {
+            max_error = std::max(max_error, std::fabs(a.data()[k] - b.data()[k]) / std::max(1.0f, std::fabs(a.data()[k])));
+        }
+    }
+
+    float sink = 0;
+    auto start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            Mat4 m;
+            getFinalMat4(&velocities[i * 3], m);
+            sink += m.m[1][2];
+        }
+    }
+    double composed = secondsSince(start);
+
+    start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            Mat4 m;
+            getBoostMat4(&velocities[i * 3], m);
+            sink += m.m[1][2];
+        }
+    }
+    double direct = secondsSince(start);
+
+    double calls = (double)count * repeats;
+    std::cout << "boost builders (" << calls << " calls)" << std::endl;
+    std::cout << "  getFinalMat4: " << composed / calls * 1e9 << " ns/call" << std::endl;
+    std::cout << "  getBoostMat4: " << direct / calls * 1e9 << " ns/call" << std::endl;
+    std::cout << "  speedup " << composed / direct << "x, max relative difference " << max_error << std::endl;
+    std::cout << "  (checksum " << sink << ")" << std::endl;
+}
+
+// Quaternion getRotMat4s against the Rodrigues version it replaced, including the
+// near-parallel velocities the old exact compares special-cased
+static void benchRotations() {
+    const int count = 1 << 16;
+    const int repeats = 20;
+    std::vector<float> velocities = randomVelocities(count, 0.99f);
+    const float edge_cases[][3] = {{0.5f, 0.0f, 0.0f}, {-0.5f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f},
+                                   {-0.5f, 1e-4f, 0.0f}, {-0.5f, 1e-8f, 1e-8f}, {0.5f, 1e-8f, 0.0f}};
+    for (const float* edge : edge_cases) {
+        velocities.insert(velocities.end(), edge, edge + 3);
+    }
+    int total = (int)velocities.size() / 3;
+
+    // Exactly antiparallel inputs may legitimately differ (old reflection vs a half turn),
+    // so each builder is checked on its own: rot * v_hat == x_hat and rot * inverseRot == I
+    float quaternion_error = 0, rodrigues_error = 0, boost_error = 0;
+    for (int i = 0; i < total; i++) {
+        const float* v = &velocities[i * 3];
+        float speed = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        Vec4 direction = {{0.0f, 1.0f, 0.0f, 0.0f}};
+        if (speed > 0) direction = {{0.0f, v[0] / speed, v[1] / speed, v[2] / speed}};
+
+        Mat4 rot, inverse_rot;
+        for (int variant = 0; variant < 2; variant++) {
+            if (variant == 0) getRotMat4s(v, rot, inverse_rot);
+            else getRotMat4sRodrigues(v, rot, inverse_rot);
+            Vec4 onto_x = mat4VectorMultiply(rot, direction);
+            Mat4 product = mat4Multiply(rot, inverse_rot);
+            float error = std::max({std::fabs(onto_x[1] - 1.0f), std::fabs(onto_x[2]), std::fabs(onto_x[3])});
+            for (int k = 0; k < 16; k++) {
+                error = std::max(error, std::fabs(product.data()[k] - identityMat4().data()[k]));
+            }
+            float& worst = variant == 0 ? quaternion_error : rodrigues_error;
+            worst = std::max(worst, error);
+        }
+
+        Mat4 composed, direct;
+        getFinalMat4(v, composed);
+        getBoostMat4(v, direct);
+        for (int k = 0; k < 16; k++) {
+            boost_error = std::max(boost_error, std::fabs(composed.data()[k] - direct.data()[k]) / std::max(1.0f, std::fabs(direct.data()[k])));
+        }
+    }
+
+    float sink = 0;
+    auto start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            Mat4 rot, inverse_rot;
+            getRotMat4sRodrigues(&velocities[i * 3], rot, inverse_rot);
+            sink += rot.m[2][3];
+        }
+    }
+    double rodrigues = secondsSince(start);
+
+    start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < count; i++) {
+            Mat4 rot, inverse_rot;
+            getRotMat4s(&velocities[i * 3], rot, inverse_rot);
+            sink += rot.m[2][3];
+        }
+    }
+    double quaternion = secondsSince(start);
+
+    double calls = (double)count * repeats;
+    std::cout << "rotation builders (" << calls << " calls)" << std::endl;
+    std::cout << "  Rodrigues: " << rodrigues / calls * 1e9 << " ns/call, max error " << rodrigues_error << std::endl;
+    std::cout << "  quaternion: " << quaternion / calls * 1e9 << " ns/call, max error " << quaternion_error << std::endl;
+    std::cout << "  speedup " << rodrigues / quaternion << "x, getFinalMat4 vs getBoostMat4 " << boost_error
+              << " (checksum " << sink << ")" << std::endl;
+}
+
+// Random (t,x,y,z) events, spread like a few minutes of capture
+static std::vector<float> randomEvents(size_t count) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> time(0.0f, 300.0f);
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    std::vector<float> events(count * 4);
+    for (size_t i = 0; i < count; i++) {
+        events[i * 4] = time(rng);
+        events[i * 4 + 1] = pos(rng);
+        events[i * 4 + 2] = pos(rng);
+        events[i * 4 + 3] = pos(rng);
+    }
+    return events;
+}
+
+// Every boostEvents variant the CPU supports, against the old one-row-at-a-time path
+static void benchBoostKernels() {
+    const size_t count = 1 << 20;
+    const int repeats = 20;
+    std::vector<float> events = randomEvents(count);
+    std::vector<float> out(count * 4), reference(count * 4);
+    float velocity[3] = {0.57f, 0.1f, -0.2f};
+    Mat4 boost;
+    getBoostMat4(velocity, boost);
+
+    BoostKernel best = detectBoostKernel();
+    setBoostKernel(BOOST_KERNEL_SCALAR);
+    boostEvents(boost, events.data(), reference.data(), count);
+
+    // Old path: malloc'd matrix, one malloc'd row result per event
+    auto start = bench_clock::now();
+    float* matrix = getBoostMatrix(velocity);
+    for (size_t i = 0; i < count; i++) {
+        float row[4] = {events[i * 4], events[i * 4 + 1], events[i * 4 + 2], events[i * 4 + 3]};
+        float* result = matrixVectorMultiply(reinterpret_cast<float(*)[4]>(matrix), reinterpret_cast<float(*)[1]>(&row));
+        std::copy(result, result + 4, out.begin() + i * 4);
+        free(result);
+    }
+    free(matrix);
+    double per_row = secondsSince(start);
+
+    std::cout << "boostEvents (" << count << " events, best kernel " << boostKernelName(best) << ")" << std::endl;
+    std::cout << "  per-row pointer API: " << count / per_row / 1e6 << " Mevents/s" << std::endl;
+
+    for (int k = BOOST_KERNEL_SCALAR; k <= best; k++) {
+        BoostKernel kernel = setBoostKernel((BoostKernel)k);
+        start = bench_clock::now();
+        for (int r = 0; r < repeats; r++) {
+            boostEvents(boost, events.data(), out.data(), count);
+        }
+        double elapsed = secondsSince(start) / repeats;
+
+        float max_error = 0;
+        for (size_t i = 0; i < count * 4; i++) {
+            max_error = std::max(max_error, std::fabs(out[i] - reference[i]) / std::max(1.0f, std::fabs(reference[i])));
+        }
+        std::cout << "  " << boostKernelName(kernel) << ": " << count / elapsed / 1e6 << " Mevents/s, "
+                  << per_row / elapsed << "x per-row, max relative difference " << max_error << std::endl;
+    }
+    setBoostKernel(best);
+}
+
+// One 36-float frame per call, the way main.cpp replays a block after capture
+static void benchBoostCache() {
+    const int frames = 1 << 18;
+    std::vector<float> events = randomEvents(9);
+    float velocity[3] = {0.57f, 0.0f, 0.0f};
+    float sink = 0;
+
+    auto start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        Mat4 boost;
+        getBoostMat4(velocity, boost);
+        float out[36];
+        boostEvents(boost, events.data(), out, 9);
+        sink += out[5];
+    }
+    double uncached = secondsSince(start);
+
+    BoostCache cache;
+    start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        Mat4 boost;
+        cache.get(velocity, boost);
+        float out[36];
+        boostEvents(boost, events.data(), out, 9);
+        sink += out[5];
+    }
+    double cached = secondsSince(start);
+
+    std::cout << "boost cache (" << frames << " frames of 9 events)" << std::endl;
+    std::cout << "  rebuild every frame: " << uncached / frames * 1e9 << " ns/frame" << std::endl;
+    std::cout << "  cached: " << cached / frames * 1e9 << " ns/frame, " << cache.hits() << " hits, "
+              << cache.misses() << " misses (checksum " << sink << ")" << std::endl;
+}
+
+// Throughput cost of the double pipeline, and what it buys on a long high-gamma session
+static void benchScalarTypes() {
+    const size_t count = 1 << 20;
+    const int repeats = 20;
+    std::vector<float> events = randomEvents(count);
+    for (size_t i = 0; i < count; i++) {
+        events[i * 4] += 3600.0f; // an hour into the session
+    }
+    std::vector<double> events_d(events.begin(), events.end());
+    std::vector<float> out(count * 4);
+    std::vector<double> out_d(count * 4);
+
+    float velocity[3] = {0.999f, 0.0f, 0.0f};
+    double velocity_d[3] = {0.999, 0.0, 0.0};
+    Mat4 boost;
+    Mat4d boost_d;
+    getBoostMat4(velocity, boost);
+    getBoostMat4(velocity_d, boost_d);
+
+    auto start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        boostEvents(boost, events.data(), out.data(), count);
+    }
+    double float_time = secondsSince(start) / repeats;
+
+    start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        boostEvents(boost_d, events_d.data(), out_d.data(), count);
+    }
+    double double_time = secondsSince(start) / repeats;
+
+    // Long double reference from the exact same inputs
+    long double beta = 0.999L;
+    long double gamma = 1.0L / std::sqrt(1.0L - beta * beta);
+    double float_error = 0, double_error = 0;
+    for (size_t i = 0; i < count; i++) {
+        long double t = events_d[i * 4], x = events_d[i * 4 + 1];
+        long double t_ref = gamma * (t - beta * x);
+        long double x_ref = gamma * (x - beta * t);
+        float_error = std::max(float_error, (double)std::max(std::fabs(out[i * 4] - t_ref), std::fabs(out[i * 4 + 1] - x_ref)));
+        double_error = std::max(double_error, (double)std::max(std::fabs(out_d[i * 4] - t_ref), std::fabs(out_d[i * 4 + 1] - x_ref)));
+    }
+
+    std::cout << "float vs double (" << count << " events at t ~ 1h, beta 0.999, " << boostKernelName(activeBoostKernel()) << ")" << std::endl;
+    std::cout << "  float: " << count / float_time / 1e6 << " Mevents/s, max abs error " << float_error << std::endl;
+    std::cout << "  double: " << count / double_time / 1e6 << " Mevents/s, max abs error " << double_error << std::endl;
+}
+
+// Float velocity path against float rapidity path for ultra-relativistic observers,
+// checked against long double. beta = 0.999 is the finally.cpp scenario.
+static void validateRapidity() {
+    const long double finally_beta = 0.999f; // exactly what finally.cpp hands the pipeline
+    const long double gammas[] = {1.0L / std::sqrt(1.0L - finally_beta * finally_beta), 1e3L, 1e4L, 1e5L, 1e6L};
+    const float direction[3] = {1.0f, 0.0f, 0.0f};
+
+    std::cout << "rapidity vs velocity (float, relative error of gamma and gamma*beta)" << std::endl;
+    for (int c = 0; c < 5; c++) {
+        long double gamma = gammas[c];
+        long double beta = std::sqrt(1.0L - 1.0L / (gamma * gamma));
+        long double gamma_beta = gamma * beta;
+
+        Rapidity rapidity;
+        float velocity[3] = {(float)beta, 0.0f, 0.0f};
+        if (c == 0) {
+            velocity[0] = 0.999f;
+            rapidityFromVelocity(velocity, rapidity);
+        } else {
+            rapidity = rapidityFromGamma((float)gamma, direction);
+        }
+
+        Mat4 from_rapidity, from_velocity;
+        getBoostMat4(rapidity, from_rapidity);
+        bool velocity_ok = getBoostMat4(velocity, from_velocity) == BOOST_OK;
+
+        std::cout << "  gamma " << (double)gamma << ": rapidity " << std::fabs(from_rapidity.m[0][0] - gamma) / gamma
+                  << " / " << std::fabs(-from_rapidity.m[0][1] - gamma_beta) / gamma_beta;
+        if (velocity_ok) {
+            std::cout << ", velocity " << std::fabs(from_velocity.m[0][0] - gamma) / gamma
+                      << " / " << std::fabs(-from_velocity.m[0][1] - gamma_beta) / gamma_beta << std::endl;
+        } else {
+            std::cout << ", velocity rejected (beta rounds to " << velocity[0] << ")" << std::endl;
+        }
+    }
+}
+
+// composeBoosts against velocity addition and the textbook Wigner angle for perpendicular
+// velocities, tan(theta) = gamma_u gamma_v u v / (gamma_u + gamma_v)
+static void validateComposition() {
+    std::cout << "boost composition (double)" << std::endl;
+    const double speeds[] = {0.1, 0.5, 0.9, 0.99};
+    for (double speed : speeds) {
+        double u[3] = {speed, 0.0, 0.0};
+        double v[3] = {0.0, speed, 0.0};
+        BoostCompositionT<double> composed;
+        composeBoosts(u, v, composed);
+
+        double added[3];
+        addVelocities(u, v, added);
+        double velocity_error = 0;
+        for (int i = 0; i < 3; i++) {
+            velocity_error = std::max(velocity_error, std::fabs(composed.velocity[i] - added[i]));
+        }
+
+        double orthonormal_error = 0;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                double dot = 0;
+                for (int k = 0; k < 3; k++) dot += composed.wigner.m[k][i] * composed.wigner.m[k][j];
+                orthonormal_error = std::max(orthonormal_error, std::fabs(dot - (i == j ? 1.0 : 0.0)));
+            }
+        }
+
+        double gamma = 1.0 / std::sqrt(1.0 - speed * speed);
+        double expected = std::atan(gamma * gamma * speed * speed / (2 * gamma));
+        double angle = std::atan2(std::fabs(composed.wigner.m[0][1]), composed.wigner.m[0][0]);
+
+        std::cout << "  u, v " << speed << " perpendicular: wigner angle " << angle << " rad (expected " << expected
+                  << "), velocity error " << velocity_error << ", orthonormal error " << orthonormal_error << std::endl;
+    }
+
+    // 1000 small kicks, each in the current rest frame, against one exact composition
+    BoostCompositionT<double> incremental;
+    double zero[3] = {0.0, 0.0, 0.0};
+    double kick[3] = {0.0005, 0.0003, 0.0};
+    composeBoosts(zero, zero, incremental);
+    for (int i = 0; i < 1000; i++) {
+        composeBoost(incremental, kick, incremental);
+    }
+    double speed = std::sqrt(incremental.velocity[0] * incremental.velocity[0] + incremental.velocity[1] * incremental.velocity[1]);
+    double expected_speed = std::tanh(1000 * std::atanh(std::sqrt(kick[0] * kick[0] + kick[1] * kick[1])));
+    std::cout << "  1000 collinear kicks: speed " << speed << " (expected " << expected_speed << ")" << std::endl;
+}
+
+// Post-capture stage: three blocks of 37-value frames, per-frame transformation() in place
+// against transformFrames on 1..hardware_concurrency threads
+static void benchTransformFrames() {
+    const size_t frames = 1 << 17;
+    std::vector<float> events = randomEvents(frames * 3 * 37 / 4 + 1);
+    std::vector<std::vector<std::vector<float>>> blocks(3, std::vector<std::vector<float>>(frames));
+    for (size_t b = 0; b < 3; b++) {
+        for (size_t f = 0; f < frames; f++) {
+            size_t offset = (b * frames + f) * 37;
+            blocks[b][f].assign(events.begin() + offset, events.begin() + offset + 37);
+        }
+    }
+    float velocity[3] = {0.57f, 0.1f, -0.2f};
+
+    auto serial = blocks;
+    auto start = bench_clock::now();
+    for (auto& block : serial) {
+        for (auto& frame : block) {
+            transformation(frame.data(), frame.data(), velocity, 36);
+        }
+    }
+    double serial_time = secondsSince(start);
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "transformFrames (3 x " << frames << " frames, " << cores << " cores)" << std::endl;
+    std::cout << "  serial transformation(): " << serial_time * 1e3 << " ms" << std::endl;
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        auto copy = blocks;
+        start = bench_clock::now();
+        transformFrames<float>({&copy[0], &copy[1], &copy[2]}, velocity, 36, threads);
+        double elapsed = secondsSince(start);
+
+        bool identical = true;
+        for (size_t b = 0; b < 3; b++) {
+            for (size_t f = 0; f < frames; f++) {
+                identical = identical && std::equal(serial[b][f].begin(), serial[b][f].end(), copy[b][f].begin());
+            }
+        }
+        std::cout << "  " << threads << " threads: " << elapsed * 1e3 << " ms, " << serial_time / elapsed
+                  << "x serial, " << (identical ? "identical" : "DIFFERENT") << " output" << std::endl;
+    }
+
+    // Hand-off cost of a pool with 3 workers (oversubscribed on small machines), against
+    // the ~4 ns an event that MIN_EVENTS_PER_PART is sized from
+    WorkerPool pool(3);
+    const int runs = 2000;
+    std::vector<int> claimed(4 * runs, 0);
+    start = bench_clock::now();
+    for (int r = 0; r < runs; r++) {
+        pool.run(4, [&](size_t part) { claimed[r * 4 + part]++; });
+    }
+    double handoff = secondsSince(start) / runs;
+    bool once = std::all_of(claimed.begin(), claimed.end(), [](int c) { return c == 1; });
+    std::cout << "  WorkerPool(3) run of 4 empty parts: " << handoff * 1e6 << " us, "
+              << (once ? "every part once" : "PARTS LOST OR REPEATED") << std::endl;
+}
+
+// K observers over one out-of-cache history: K separate boostEvents passes against one
+// boostEventsMulti pass, plus transformObservers against transformation() per observer
+static void benchMultiObserver() {
+    const size_t count = 1 << 22;
+    const int repeats = 5;
+    const int observers = 4;
+    std::vector<float> events = randomEvents(count);
+    float velocities[observers * 3] = {0.3f, 0.0f, 0.0f, 0.6f, 0.0f, 0.0f, 0.9f, 0.0f, 0.0f, 0.5f, 0.5f, 0.0f};
+    Mat4 boosts[observers];
+    std::vector<std::vector<float>> separate(observers, std::vector<float>(count * 4)), multi = separate;
+    float* outs[observers];
+    for (int k = 0; k < observers; k++) {
+        getBoostMat4(&velocities[k * 3], boosts[k]);
+        outs[k] = multi[k].data();
+    }
+
+    auto start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int k = 0; k < observers; k++) {
+            boostEvents(boosts[k], events.data(), separate[k].data(), count);
+        }
+    }
+    double separate_time = secondsSince(start) / repeats;
+
+    start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        boostEventsMulti(boosts, observers, events.data(), outs, count);
+    }
+    double multi_time = secondsSince(start) / repeats;
+
+    bool identical = separate == multi;
+
+    // Replay datasets: 9-event frames, as main.cpp loads them
+    std::vector<std::vector<float>> frames(count / 9);
+    for (size_t f = 0; f < frames.size(); f++) {
+        frames[f].assign(events.begin() + f * 36, events.begin() + f * 36 + 37);
+    }
+    // Results are freed outside the timed region. Either way the vector API is bound by
+    // allocating (and page-faulting in) the output frames, which costs far more than
+    // boosting them; benchStoreObservers times the store path callers use.
+    double per_observer_time = 1e9, observers_time = 1e9;
+    std::vector<std::vector<std::vector<float>>> datasets, copies(observers);
+    for (int r = 0; r < repeats; r++) {
+        copies.assign(observers, {});
+        start = bench_clock::now();
+        for (int k = 0; k < observers; k++) {
+            copies[k] = frames;
+            for (auto& frame : copies[k]) {
+                transformation(frame.data(), frame.data(), &velocities[k * 3], 36);
+            }
+        }
+        per_observer_time = std::min(per_observer_time, secondsSince(start));
+        datasets.clear();
+        start = bench_clock::now();
+        datasets = transformObservers(frames, velocities, observers);
+        observers_time = std::min(observers_time, secondsSince(start));
+    }
+    for (int k = 0; k < observers && identical; k++) {
+        for (size_t f = 0; f < frames.size() && identical; f++) {
+            std::vector<float> expected = frames[f];
+            transformation(expected.data(), expected.data(), &velocities[k * 3], 36);
+            identical = expected == datasets[k][f];
+        }
+    }
+
+    std::cout << "multi-observer (" << observers << " observers x " << count << " events)" << std::endl;
+    std::cout << "  separate passes: " << separate_time * 1e3 << " ms" << std::endl;
+    std::cout << "  boostEventsMulti: " << multi_time * 1e3 << " ms, " << separate_time / multi_time << "x, "
+              << (identical ? "identical" : "DIFFERENT") << " output" << std::endl;
+    std::cout << "  " << frames.size() << " 9-event frames: copy + transformation() per observer " << per_observer_time * 1e3
+              << " ms, transformObservers " << observers_time * 1e3 << " ms (" << per_observer_time / observers_time << "x; "
+              << "both bound by allocating " << observers * frames.size() << " output frames)" << std::endl;
+}
+
+// K observers of one capture in an EventStore: transformInto writing K boosted stores in
+// one pass over the history, against a pass per observer, and one store boosted in place
+// by transform() for what a single observer costs without a copy
+static void benchStoreObservers() {
+    const int frames = 1 << 16;
+    const int groups = 9;
+    const int repeats = 5;
+    std::vector<float> coordinates = randomEvents((size_t)frames * 3 * groups);
+    for (size_t i = 0; i < coordinates.size() / 4; i++) {
+        coordinates[i * 4] = (i / (3 * groups)) / 30.0f;
+    }
+    auto fill = [&](EventStore& store) {
+        for (int f = 0; f < frames; f++) {
+            store.beginFrame(3 * groups);
+            for (int b = 0; b < 3; b++) {
+                store.appendRows(b, &coordinates[((size_t)f * 3 + b) * groups * 4], groups);
+            }
+        }
+    };
+    EventStore source, in_place;
+    fill(source);
+    const Mat4 boosts[4] = {boostMat4(0.3f, 0.0f, 0.0f), boostMat4(0.6f, 0.0f, 0.0f),
+                            boostMat4(0.57f, 0.1f, -0.2f), boostMat4(0.5f, 0.5f, 0.0f)};
+
+    double in_place_time = 1e9;
+    for (int r = 0; r < repeats; r++) {
+        source.transformInto(boosts, 1, &in_place); // a copy to boost in place
+        auto start = bench_clock::now();
+        in_place.transform(boosts[0]);
+        in_place_time = std::min(in_place_time, secondsSince(start));
+    }
+    std::cout << "EventStore observers (" << frames << " frames x " << 3 * groups << " events)" << std::endl;
+    std::cout << "  transform() in place, 1 observer: " << in_place_time * 1e3 << " ms" << std::endl;
+    for (int observers = 1; observers <= 4; observers *= 2) {
+        std::vector<EventStore> separate(observers), multi(observers);
+        double separate_time = 1e9, multi_time = 1e9;
+        for (int r = 0; r < repeats; r++) {
+            auto start = bench_clock::now();
+            for (int k = 0; k < observers; k++) {
+                source.transformInto(&boosts[k], 1, &separate[k]);
+            }
+            separate_time = std::min(separate_time, secondsSince(start));
+            start = bench_clock::now();
+            source.transformInto(boosts, observers, multi.data());
+            multi_time = std::min(multi_time, secondsSince(start));
+        }
+
+        bool identical = true;
+        std::vector<std::vector<float>> expected, got;
+        for (int k = 0; k < observers; k++) {
+            EventStore reference;
+            fill(reference);
+            reference.transform(boosts[k]);
+            for (uint32_t b = 0; b < 3; b++) {
+                reference.blockFrames(b, expected);
+                multi[k].blockFrames(b, got);
+                identical = identical && expected == got;
+            }
+        }
+        std::cout << "  " << observers << " observers: a pass each " << separate_time * 1e3 << " ms, one pass "
+                  << multi_time * 1e3 << " ms (" << separate_time / multi_time << "x), "
+                  << (identical ? "identical" : "DIFFERENT") << " output" << std::endl;
+    }
+}
+
+// Replay path per rendered frame: lookup_row copies + vectorToFloatPointer + pts_to_vertices
+// against indexing the buffers process_to_vertices filled once
+static void benchReplayVertices() {
+    const size_t timesteps = 1 << 14;
+    const int frames = 1 << 18;
+    std::vector<float> events = randomEvents(timesteps * 9);
+    std::vector<std::vector<std::vector<float>>> processed(9, std::vector<std::vector<float>>(timesteps));
+    std::vector<float> times(timesteps);
+    for (size_t t = 0; t < timesteps; t++) {
+        times[t] = (float)t;
+        for (int g = 0; g < 9; g++) {
+            processed[g][t].assign(events.begin() + (t * 9 + g) * 4, events.begin() + (t * 9 + g) * 4 + 4);
+        }
+    }
+
+    auto start = bench_clock::now();
+    auto points = process_to_points(processed);
+    auto centers_2d = get_lorentz_center_pos(processed);
+    double old_setup = secondsSince(start);
+
+    start = bench_clock::now();
+    std::vector<float> vertices, centers;
+    process_to_vertices(processed, vertices, centers);
+    double fused_setup = secondsSince(start);
+
+    float max_error = 0;
+    for (size_t t = 0; t < timesteps; t++) {
+        float* expected = pts_to_vertices(points[t].data(), 4);
+        for (int i = 0; i < CUBE_MESH_FLOATS; i++) {
+            max_error = std::max(max_error, std::fabs(expected[i] - vertices[t * CUBE_MESH_FLOATS + i]));
+        }
+        for (int i = 0; i < 3; i++) {
+            max_error = std::max(max_error, std::fabs(centers_2d[t][i] - centers[t * 3 + i]));
+        }
+        delete[] expected;
+    }
+
+    float sink = 0;
+    start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        float frame_time = (float)(f % timesteps) + 0.5f;
+        float* corners = vectorToFloatPointer(lookup_row(times, points, frame_time));
+        float* center = vectorToFloatPointer(lookup_row(times, centers_2d, frame_time));
+        float* mesh = pts_to_vertices(corners, 4);
+        sink += mesh[40] + center[1];
+        delete[] corners;
+        delete[] center;
+        delete[] mesh;
+    }
+    double old_frames = secondsSince(start);
+
+    start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        float frame_time = (float)(f % timesteps) + 0.5f;
+        int row = lookup_index(times, frame_time);
+        const float* mesh = &vertices[row * CUBE_MESH_FLOATS];
+        const float* center = &centers[row * 3];
+        sink += mesh[40] + center[1];
+    }
+    double fused_frames = secondsSince(start);
+
+    std::cout << "replay vertices (" << timesteps << " timesteps, " << frames << " frames)" << std::endl;
+    std::cout << "  setup: process_to_points + centers " << old_setup * 1e3 << " ms, process_to_vertices "
+              << fused_setup * 1e3 << " ms" << std::endl;
+    std::cout << "  per frame: copies " << old_frames / frames * 1e9 << " ns, indexed " << fused_frames / frames * 1e9
+              << " ns, max difference " << max_error << " (checksum " << sink << ")" << std::endl;
+}
+
+// Overhead of the opt-in interval validation on big batches and on 9-event frames,
+// the error it reports for every kernel, and that it notices a matrix that is not a boost
+static void benchIntervalValidation() {
+    const size_t count = 1 << 20;
+    const int repeats = 20;
+    const int frames = 1 << 13;
+    const int frame_rounds = 600;
+    std::vector<float> events = randomEvents(count);
+    std::vector<float> out(count * 4);
+    float velocity[3] = {0.57f, 0.1f, -0.2f};
+    Mat4 boost;
+    getBoostMat4(velocity, boost);
+
+    BoostKernel best = detectBoostKernel();
+    std::cout << "interval validation (default stride, 1 block in 1024 checked)" << std::endl;
+    for (int k = BOOST_KERNEL_SCALAR; k <= best; k++) {
+        BoostKernel kernel = setBoostKernel((BoostKernel)k);
+        // Best of rounds, alternating off and on, so clock drift hits both alike. Frame rounds
+        // are short and many: a 9-event call is ~10 ns, so one preempted round is no signal.
+        double times[2][2] = {{1e9, 1e9}, {1e9, 1e9}};
+        resetIntervalReport();
+        for (int round = 0; round < 5; round++) {
+            for (int validated = 0; validated < 2; validated++) {
+                setIntervalValidation(validated == 1);
+                auto start = bench_clock::now();
+                for (int r = 0; r < repeats; r++) {
+                    boostEvents(boost, events.data(), out.data(), count);
+                }
+                times[validated][0] = std::min(times[validated][0], secondsSince(start) / repeats);
+            }
+        }
+        for (int round = 0; round < frame_rounds; round++) {
+            for (int validated = 0; validated < 2; validated++) {
+                setIntervalValidation(validated == 1);
+                float frame[36];
+                auto start = bench_clock::now();
+                for (int f = 0; f < frames; f++) {
+                    boostEvents(boost, events.data() + (f % 1024) * 36, frame, 9);
+                }
+                times[validated][1] = std::min(times[validated][1], secondsSince(start) / frames);
+            }
+        }
+        IntervalReport report = intervalReport();
+        std::cout << "  " << boostKernelName(kernel) << ": batch overhead " << (times[1][0] / times[0][0] - 1) * 100
+                  << "%, frame overhead " << (times[1][1] / times[0][1] - 1) * 100 << "%, " << report.pairs
+                  << " pairs in " << report.events << " events, check " << report.check_seconds * 1e3 << " ms vs kernel "
+                  << report.kernel_seconds * 1e3 << " ms, " << report.pairs / report.check_seconds / 1e6
+                  << " Mpairs/s, max error " << report.max_error << std::endl;
+    }
+    setBoostKernel(best);
+
+    std::vector<float> intervals(count / 2), norms(count / 2);
+    auto start = bench_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        pairIntervals(events.data(), intervals.data(), norms.data(), count / 2);
+    }
+    double interval_time = secondsSince(start) / repeats;
+    std::cout << "  pairIntervals (" << boostKernelName(best) << "): " << count / 2 / interval_time / 1e6 << " Mpairs/s" << std::endl;
+
+    // The spatial block of a boost with the sign of the mixed terms flipped on one side only
+    Mat4 broken = boost;
+    broken.m[1][0] = -broken.m[1][0];
+    setIntervalValidation(true);
+    resetIntervalReport();
+    boostEvents(broken, events.data(), out.data(), count);
+    std::cout << "  broken matrix: max error " << intervalReport().max_error << std::endl;
+    setIntervalValidation(false);
+}
+
+// Ten minutes of main's capture (a 9x4x5 block drifting and slowly turning, 30 frames a
+// second) kept as CompactHistory against std::vector<std::vector<float>>
+static void benchCompactHistory() {
+    const int frames = 30 * 600;
+    const float half_size[3] = {4.5f, 2.0f, 2.5f};
+    std::vector<std::vector<float>> capture(frames);
+    for (int f = 0; f < frames; f++) {
+        float t = f / 30.0f;
+        float center[3] = {-7.0f + 0.02f * t, 1.0f, 1.0f + 0.01f * t};
+        std::vector<float>& frame = capture[f];
+        frame.insert(frame.end(), {t, center[0], center[1], center[2]});
+        float turn = 0.05f * t;
+        for (int c = 0; c < 8; c++) {
+            float corner[3];
+            for (int k = 0; k < 3; k++) {
+                corner[k] = (c >> k) & 1 ? half_size[k] : -half_size[k];
+            }
+            frame.insert(frame.end(), {t, center[0] + std::cos(turn) * corner[0] + std::sin(turn) * corner[2],
+                                       center[1] + corner[1], center[2] - std::sin(turn) * corner[0] + std::cos(turn) * corner[2]});
+        }
+    }
+
+    // What storing the absolute values in fp16 would lose, for comparison
+    double absolute_error = 0;
+    for (const std::vector<float>& frame : capture) {
+        for (float value : frame) {
+            absolute_error = std::max(absolute_error, (double)std::fabs(halfToFloat(floatToHalf(value, HALF_FP16), HALF_FP16) - value));
+        }
+    }
+
+    float velocity[3] = {0.6f, 0.3f, -0.2f};
+    std::vector<std::vector<float>> expected(frames);
+    for (int f = 0; f < frames; f++) {
+        expected[f].resize(36);
+    }
+    auto start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        transformation(capture[f].data(), expected[f].data(), velocity, 36);
+    }
+    double float_time = secondsSince(start);
+
+    std::cout << "compact history (" << frames << " frames, fp16 absolute values would be off by " << absolute_error << ")" << std::endl;
+    for (HalfFormat format : {HALF_FP16, HALF_BF16}) {
+        CompactHistory history(format);
+        history.reserve(frames);
+        for (const std::vector<float>& frame : capture) {
+            history.append(frame.data());
+        }
+        std::vector<std::vector<float>> boosted;
+        history.transform(velocity, boosted); // allocates the output frames
+        start = bench_clock::now();
+        history.transform(velocity, boosted);
+        double compact_time = secondsSince(start);
+
+        double boosted_error = 0;
+        for (int f = 0; f < frames; f++) {
+            for (int i = 0; i < 36; i++) {
+                boosted_error = std::max(boosted_error, (double)std::fabs(boosted[f][i] - expected[f][i]));
+            }
+        }
+        std::cout << "  " << (format == HALF_FP16 ? "fp16" : "bf16") << ": " << history.bytes() / 1024 << " KiB vs "
+                  << history.floatBytes() / 1024 << " KiB (" << (double)history.floatBytes() / history.bytes()
+                  << "x), capture error " << history.maxError() << ", boosted error " << boosted_error
+                  << ", transform " << compact_time * 1e3 << " ms vs " << float_time * 1e3 << " ms" << std::endl;
+    }
+}
+
+// A block moving at constant velocity: the rigid fast path (center worldline only) against
+// transformFrames boosting all 9 events of every frame
+static void benchRigidBlocks() {
+    const int frames = 1 << 16;
+    const int repeats = 10;
+    const float half_size[3] = {4.5f, 2.0f, 2.5f};
+    const float block_velocity[3] = {0.3f, 0.0f, -0.1f};
+    std::vector<std::vector<float>> capture(frames);
+    for (int f = 0; f < frames; f++) {
+        float t = f / 30.0f;
+        float center[3] = {-7.0f + block_velocity[0] * t, 1.0f, 1.0f + block_velocity[2] * t};
+        capture[f] = {t, center[0], center[1], center[2]};
+        for (int c = 0; c < 8; c++) {
+            capture[f].push_back(t);
+            for (int k = 0; k < 3; k++) {
+                capture[f].push_back(center[k] + ((c >> k) & 1 ? half_size[k] : -half_size[k]));
+            }
+        }
+    }
+    float velocity[3] = {0.6f, 0.3f, -0.2f};
+
+    RigidBlock block;
+    bool rigid = false;
+    std::vector<std::vector<float>> general;
+    std::vector<float> centers;
+    double fit_time = 1e9, general_time = 1e9, rigid_time = 1e9;
+    for (int r = 0; r < repeats; r++) {
+        auto start = bench_clock::now();
+        rigid = fitRigidBlock(capture, velocity, 1e-3f, block);
+        fit_time = std::min(fit_time, secondsSince(start));
+
+        general = capture;
+        start = bench_clock::now();
+        transformFrames<float>({&general}, velocity, 36, 1);
+        general_time = std::min(general_time, secondsSince(start));
+
+        start = bench_clock::now();
+        boostRigidCenters(block, capture, centers);
+        rigid_time = std::min(rigid_time, secondsSince(start));
+    }
+
+    // Each boosted corner event against the block at that event's observer time
+    float max_error = 0;
+    float corners[24];
+    for (int f = 0; f < frames; f++) {
+        for (int k = 0; k < 8; k++) {
+            const float* e = &general[f][4 + k * 4];
+            float dt = e[0] - centers[f * 4];
+            float center[3];
+            for (int i = 0; i < 3; i++) {
+                center[i] = centers[f * 4 + 1 + i] + block.velocity[i] * dt;
+            }
+            rigidCorners(block, center, corners);
+            for (int i = 0; i < 3; i++) {
+                max_error = std::max(max_error, std::fabs(corners[k * 3 + i] - e[i + 1]) / std::max(1.0f, std::fabs(e[i + 1])));
+            }
+        }
+    }
+    std::cout << "rigid blocks (" << frames << " frames, fit " << (rigid ? "ok" : "failed") << " in " << fit_time * 1e3
+              << " ms): transformFrames " << general_time * 1e3 << " ms, boostRigidCenters " << rigid_time * 1e3 << " ms ("
+              << general_time / rigid_time << "x), max relative difference " << max_error << std::endl;
+}
+
+// boostEventsAxis against boostEvents for x, y and z boosts on every kernel: in-cache batches,
+// 9-event frames and a batch from memory, and that its output and the constexpr builder match
+static void benchAxisBoost() {
+    const size_t count = 1 << 20;
+    const size_t batch = 4096;
+    const size_t frame_events = 9;
+    const int rounds = 1000;
+    std::vector<float> events = randomEvents(count);
+    std::vector<float> out(count * 4), reference(count * 4);
+
+    // Folded at compile time; must match the runtime builder
+    constexpr Mat4 fixed = boostMat4(0.57f, 0.0f, 0.0f);
+    static_assert(fixed.m[0][0] > 1.21f && fixed.m[0][0] < 1.22f, "gamma(0.57) folds to ~1.218");
+    static_assert(boostAxis(fixed) == 1, "x boost is axis-aligned");
+    float fixed_velocity[3] = {0.57f, 0.0f, 0.0f};
+    Mat4 runtime;
+    getBoostMat4(fixed_velocity, runtime);
+    float builder_difference = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            builder_difference = std::max(builder_difference, std::fabs(fixed.m[i][j] - runtime.m[i][j]));
+        }
+    }
+    std::cout << "axis-aligned boost (" << batch << "-event batches, " << frame_events << "-event frames, and "
+              << count << " events from memory)" << std::endl;
+    std::cout << "  constexpr boostMat4 vs getBoostMat4: max difference " << builder_difference << std::endl;
+    failures += builder_difference != 0;
+
+    BoostKernel best = detectBoostKernel();
+    for (int k = BOOST_KERNEL_SCALAR; k <= best; k++) {
+        BoostKernel kernel = setBoostKernel((BoostKernel)k);
+        for (int axis = 1; axis <= 3; axis++) {
+            float velocity[3] = {0, 0, 0};
+            velocity[axis - 1] = 0.57f;
+            Mat4 boost;
+            getBoostMat4(velocity, boost);
+            boostEvents(boost, events.data(), reference.data(), count);
+            boostEventsAxis(boostAxis(velocity), boost, events.data(), out.data(), count);
+            size_t mismatches = 0;
+            for (size_t i = 0; i < count * 4; i++) {
+                mismatches += out[i] != reference[i];
+            }
+            failures += mismatches != 0;
+
+            // Best of short rounds, alternating the two paths and which goes first: a 4096-event
+            // batch and 9-event frames from a 1024-frame window, both in cache, and the whole
+            // batch from memory
+            double general = 1e9, aligned = 1e9, general_frames = 1e9, aligned_frames = 1e9;
+            double general_memory = 1e9, aligned_memory = 1e9;
+            for (int round = 0; round < rounds; round++) {
+                for (int turn = 0; turn < 2; turn++) {
+                    int use_axis = turn ^ (round & 1);
+                    auto start = bench_clock::now();
+                    for (int r = 0; r < 16; r++) {
+                        if (use_axis) boostEventsAxis(axis, boost, events.data(), out.data(), batch);
+                        else boostEvents(boost, events.data(), out.data(), batch);
+                    }
+                    double& batch_time = use_axis ? aligned : general;
+                    batch_time = std::min(batch_time, secondsSince(start));
+
+                    start = bench_clock::now();
+                    for (size_t f = 0; f < 4096; f++) {
+                        size_t at = (f % 1024) * frame_events * 4;
+                        if (use_axis) boostEventsAxis(axis, boost, events.data() + at, out.data() + at, frame_events);
+                        else boostEvents(boost, events.data() + at, out.data() + at, frame_events);
+                    }
+                    double& frame_time = use_axis ? aligned_frames : general_frames;
+                    frame_time = std::min(frame_time, secondsSince(start));
+
+                    if (round % 100 == 0) {
+                        start = bench_clock::now();
+                        if (use_axis) boostEventsAxis(axis, boost, events.data(), out.data(), count);
+                        else boostEvents(boost, events.data(), out.data(), count);
+                        double& memory_time = use_axis ? aligned_memory : general_memory;
+                        memory_time = std::min(memory_time, secondsSince(start));
+                    }
+                }
+            }
+
+            std::cout << "  " << boostKernelName(kernel) << " axis " << axis << ": batch " << general / aligned
+                      << "x, frames " << general_frames / aligned_frames << "x, from memory "
+                      << general_memory / aligned_memory << "x, " << mismatches
+                      << " values differ from boostEvents" << std::endl;
+        }
+    }
+    setBoostKernel(best);
+}
+
+// main's capture into vector-of-vector frames against an EventStore: capture, transform and
+// processEvents times, memory, and whether both give the same boosted events and groups
+static void benchEventStore() {
+    const int frames = 1 << 16;
+    const int groups = 9;
+    const int repeats = 5;
+    // main's capture: three blocks of 9 events per frame, all at the frame's time
+    std::vector<float> coordinates = randomEvents((size_t)frames * 3 * groups);
+    std::vector<std::vector<float>> rows(3 * (size_t)frames);
+    for (size_t k = 0; k < rows.size(); k++) {
+        rows[k].assign(coordinates.begin() + k * groups * 4, coordinates.begin() + (k + 1) * groups * 4);
+        for (int g = 0; g < groups; g++) {
+            rows[k][g * 4] = (k / 3) / 30.0f;
+        }
+    }
+    constexpr Mat4 boost = boostMat4(0.57f, 0.1f, -0.2f);
+
+    double vector_times[3] = {1e9, 1e9, 1e9}, store_times[3] = {1e9, 1e9, 1e9};
+    std::vector<std::vector<std::vector<float>>> vector_result[3], store_result[3];
+    std::vector<std::vector<float>> vector_boosted[3], store_boosted[3];
+    size_t store_bytes = 0;
+    for (int r = 0; r < repeats; r++) {
+        // vector-of-vector frame buffers, as main had them
+        auto start = bench_clock::now();
+        std::vector<std::vector<float>> blocks[3];
+        for (int b = 0; b < 3; b++) {
+            blocks[b].resize(frames);
+        }
+        for (int f = 0; f < frames; f++) {
+            for (int b = 0; b < 3; b++) {
+                blocks[b][f].resize(groups * 4);
+                std::copy(rows[f * 3 + b].begin(), rows[f * 3 + b].end(), blocks[b][f].begin());
+            }
+        }
+        vector_times[0] = std::min(vector_times[0], secondsSince(start));
+        start = bench_clock::now();
+        transformFrames<float>({&blocks[0], &blocks[1], &blocks[2]}, boost, groups * 4, 1);
+        vector_times[1] = std::min(vector_times[1], secondsSince(start));
+        for (int b = 0; b < 3; b++) {
+            vector_boosted[b] = blocks[b];
+        }
+        start = bench_clock::now();
+        for (int b = 0; b < 3; b++) {
+            vector_result[b] = processEvents(blocks[b], groups);
+        }
+        vector_times[2] = std::min(vector_times[2], secondsSince(start));
+
+        start = bench_clock::now();
+        EventStore store;
+        for (int f = 0; f < frames; f++) {
+            store.beginFrame(3 * groups);
+            for (int b = 0; b < 3; b++) {
+                store.appendRows(b, rows[f * 3 + b].data(), groups);
+            }
+        }
+        store_times[0] = std::min(store_times[0], secondsSince(start));
+        start = bench_clock::now();
+        store.transform(boost);
+        store_times[1] = std::min(store_times[1], secondsSince(start));
+        for (int b = 0; b < 3; b++) {
+            store.blockFrames(b, store_boosted[b]);
+        }
+        start = bench_clock::now();
+        for (int b = 0; b < 3; b++) {
+            store_result[b] = processEvents(store, b, groups);
+        }
+        store_times[2] = std::min(store_times[2], secondsSince(start));
+        store_bytes = store.bytes();
+    }
+
+    // processEvents sorts by t', which the last-bit differences between the two transforms
+    // can reorder, so the boosted events are compared before it and the groups by shape
+    float max_difference = 0;
+    bool same_shape = true;
+    for (int b = 0; b < 3; b++) {
+        for (int f = 0; f < frames; f++) {
+            for (int k = 0; k < groups * 4; k++) {
+                float a = vector_boosted[b][f][k], c = store_boosted[b][f][k];
+                max_difference = std::max(max_difference, std::fabs(a - c) / std::max(1.0f, std::fabs(a)));
+            }
+        }
+        same_shape = same_shape && vector_result[b].size() == store_result[b].size();
+        for (size_t g = 0; same_shape && g < vector_result[b].size(); g++) {
+            same_shape = vector_result[b][g].size() == store_result[b][g].size();
+        }
+    }
+    size_t vector_bytes = 3 * (size_t)frames * (groups * 4 * sizeof(float) + sizeof(std::vector<float>));
+    std::cout << "event store (3 blocks x " << frames << " frames of " << groups << " events)" << std::endl;
+    const char* stages[3] = {"capture", "transform", "processEvents"};
+    for (int i = 0; i < 3; i++) {
+        std::cout << "  " << stages[i] << ": vectors " << vector_times[i] * 1e3 << " ms, store "
+                  << store_times[i] * 1e3 << " ms (" << vector_times[i] / store_times[i] << "x)" << std::endl;
+    }
+    std::cout << "  " << store_bytes << " bytes in chunks vs " << vector_bytes << " in vectors (heap overhead not counted), "
+              << (same_shape ? "same groups" : "DIFFERENT groups") << ", max relative difference " << max_difference << std::endl;
+}
+
+// EventStore::transform against boostEvents on the same rows: a general and an x boost,
+// whether the output matches, and what interval validation sees of it
+static void benchStoreTransform() {
+    const int frames = 1 << 16;
+    const int groups = 9;
+    const int rounds = 50;
+    std::vector<float> rows = randomEvents((size_t)frames * groups);
+    const Mat4 boosts[2] = {boostMat4(0.57f, 0.1f, -0.2f), boostMat4(0.57f, 0.0f, 0.0f)};
+    const Mat4 inverses[2] = {boostMat4(-0.57f, -0.1f, 0.2f), boostMat4(-0.57f, 0.0f, 0.0f)};
+    const char* names[2] = {"general", "x axis"};
+    // Float boosts of these events measure ~6e-6
+    const double interval_tolerance = 1e-4;
+
+    std::cout << "store transform (" << frames << " frames of " << groups << " events, "
+              << WorkerPool::instance().threads() << " threads)" << std::endl;
+    for (int b = 0; b < 2; b++) {
+        EventStore store;
+        for (int f = 0; f < frames; f++) {
+            store.beginFrame(groups);
+            store.appendRows(0, rows.data() + (size_t)f * groups * 4, groups);
+        }
+        // The scalar kernel, since the SIMD ones fuse multiply-adds and the store's do not
+        setBoostKernel(BOOST_KERNEL_SCALAR);
+        std::vector<float> reference(rows.size());
+        boostEvents(boosts[b], rows.data(), reference.data(), (size_t)frames * groups);
+        setBoostKernel(detectBoostKernel());
+        store.transform(boosts[b]);
+        std::vector<std::vector<float>> boosted;
+        store.blockFrames(0, boosted);
+        size_t mismatches = 0;
+        for (int f = 0; f < frames; f++) {
+            for (int k = 0; k < groups * 4; k++) {
+                mismatches += boosted[f][k] != reference[(size_t)f * groups * 4 + k];
+            }
+        }
+
+        // Off and on alternate, each boost undone by its inverse so the events stay in range
+        double times[2] = {1e9, 1e9};
+        resetIntervalReport();
+        for (int round = 0; round < rounds; round++) {
+            for (int validated = 0; validated < 2; validated++) {
+                setIntervalValidation(validated == 1);
+                store.transform(inverses[b]);
+                auto start = bench_clock::now();
+                store.transform(boosts[b]);
+                times[validated] = std::min(times[validated], secondsSince(start));
+            }
+        }
+        setIntervalValidation(false);
+        IntervalReport report = intervalReport();
+        failures += mismatches != 0 || report.pairs == 0 || !(report.max_error <= interval_tolerance); // NaN fails too
+        std::cout << "  " << names[b] << ": " << times[0] * 1e3 << " ms, " << (double)frames * groups / times[0] / 1e6
+                  << " Mevents/s, " << mismatches << " values differ from boostEvents; validated "
+                  << (times[1] / times[0] - 1) * 100 << "% slower, " << report.pairs << " pairs, max error "
+                  << report.max_error << std::endl;
+    }
+}
+
+// Two hours of capture into an EventStore held in RAM against one spilling past a 16 MB budget:
+// capture and transform times, peak RAM and bytes on disk
+static void benchEventSpill() {
+    const int frames = 2 * 3600 * 30; // two hours at 30 FPS
+    const int groups = 9;
+    const size_t budget = 16 << 20;
+    std::vector<float> coordinates = randomEvents(3 * groups);
+    constexpr Mat4 boost = boostMat4(0.57f, 0.0f, 0.0f);
+
+    std::cout << "event store spill (3 blocks x " << frames << " frames, " << (budget >> 20) << " MB budget)" << std::endl;
+    for (int spill = 0; spill < 2; spill++) {
+        EventStore store;
+        if (spill && !store.setSpill("boost_bench_spill.bin", budget)) {
+            return;
+        }
+        size_t peak = 0;
+        auto start = bench_clock::now();
+        for (int f = 0; f < frames; f++) {
+            store.beginFrame(3 * groups);
+            for (int g = 0; g < 3 * groups; g++) {
+                coordinates[g * 4] = f / 30.0f;
+            }
+            for (int b = 0; b < 3; b++) {
+                store.appendRows(b, coordinates.data() + b * groups * 4, groups);
+            }
+            peak = std::max(peak, store.bytes());
+        }
+        double capture = secondsSince(start);
+        start = bench_clock::now();
+        store.transform(boost);
+        double transform = secondsSince(start);
+        std::cout << "  " << (spill ? "spilling" : "in RAM") << ": capture " << capture * 1e3 << " ms, transform "
+                  << transform * 1e3 << " ms, peak " << (peak >> 20) << " MB in RAM, "
+                  << (store.spilledBytes() >> 20) << " MB on disk" << std::endl;
+    }
+}
+
+// Replay setup from a boosted store, main's scene shape (box corners around a center, one
+// block at rest): processEvents + process_to_vertices + average_start_times against
+// processVertices, with and without static elision
+static void benchStoreVertices() {
+    const int frames = 1 << 15;
+    const int groups = 9;
+    const int repeats = 3;
+    std::vector<float> body = cube_vertices(9, 4, 5, 4);
+    constexpr Mat4 boost = boostMat4(0.57f, 0.1f, -0.2f);
+    std::cout << "replay setup from a store (3 blocks x " << frames << " frames)" << std::endl;
+    for (int elide = 0; elide < 2; elide++) {
+        EventStore store;
+        store.setStaticElision(elide != 0);
+        std::vector<float> rows(groups * 4);
+        for (int f = 0; f < frames; f++) {
+            float t = f / 30.0f;
+            store.beginFrame(3 * groups);
+            for (int b = 0; b < 3; b++) {
+                float center[3] = {-7.0f + (b == 1 ? 0.3f * t : 0), 1.0f + (b == 2 ? 0.2f * std::sin(t) : 0), 1.0f};
+                for (int g = 0; g < groups; g++) {
+                    rows[g * 4] = t;
+                    for (int i = 0; i < 3; i++) {
+                        rows[g * 4 + 1 + i] = center[i] + (g == 0 ? 0 : body[(g - 1) * 3 + i]);
+                    }
+                }
+                store.appendRows(b, rows.data(), groups);
+            }
+        }
+        store.transform(boost);
+
+        double old_time = 1e9, new_time = 1e9;
+        bool identical = true;
+        for (int r = 0; r < repeats; r++) {
+            std::vector<float> old_vertices[3], old_centers[3], vertices[3], centers[3];
+            std::vector<float> old_times[3], times[3];
+            auto start = bench_clock::now();
+            for (int b = 0; b < 3; b++) {
+                auto processed = processEvents(store, b, groups);
+                process_to_vertices(processed, old_vertices[b], old_centers[b]);
+                old_times[b] = average_start_times(processed);
+            }
+            old_time = std::min(old_time, secondsSince(start));
+            start = bench_clock::now();
+            for (int b = 0; b < 3; b++) {
+                processVertices(store, b, vertices[b], centers[b], times[b]);
+            }
+            new_time = std::min(new_time, secondsSince(start));
+            for (int b = 0; b < 3; b++) {
+                identical = identical && vertices[b] == old_vertices[b] && centers[b] == old_centers[b] && times[b] == old_times[b];
+            }
+        }
+        std::cout << "  " << (elide ? "static elision" : "all stored") << ": processEvents path " << old_time * 1e3
+                  << " ms, processVertices " << new_time * 1e3 << " ms (" << old_time / new_time << "x), "
+                  << (identical ? "identical" : "DIFFERENT") << " output" << std::endl;
+    }
+}
+
+// main's scene, where every block is at rest, and one with block 1 moving: the same capture
+// into a plain store and one eliding static blocks
+static void benchStaticElision() {
+    const int frames = 1 << 16;
+    const int groups = 9;
+    std::vector<float> body = randomEvents(3 * groups);
+    constexpr Mat4 boost = boostMat4(0.57f, 0.1f, -0.2f);
+    std::cout << "static elision (3 blocks x " << frames << " frames of " << groups << " events)" << std::endl;
+    for (int moving = 0; moving < 2; moving++) {
+        EventStore stores[2];
+        stores[1].setStaticElision(true);
+        double times[2][3];
+        std::vector<float> rows(groups * 4);
+        for (int e = 0; e < 2; e++) {
+            auto start = bench_clock::now();
+            for (int f = 0; f < frames; f++) {
+                float t = f / 30.0f;
+                stores[e].beginFrame(3 * groups);
+                for (int b = 0; b < 3; b++) {
+                    for (int g = 0; g < groups; g++) {
+                        rows[g * 4] = t;
+                        for (int i = 1; i < 4; i++) {
+                            rows[g * 4 + i] = body[(b * groups + g) * 4 + i] + (moving && b == 1 && i == 1 ? 0.3f * t : 0);
+                        }
+                    }
+                    stores[e].appendRows(b, rows.data(), groups);
+                }
+            }
+            times[e][0] = secondsSince(start);
+            start = bench_clock::now();
+            stores[e].transform(boost);
+            times[e][1] = secondsSince(start);
+        }
+
+        float max_difference = 0;
+        bool same_shape = true;
+        double process[2] = {0, 0};
+        for (int b = 0; b < 3; b++) {
+            std::vector<std::vector<float>> boosted[2];
+            std::vector<size_t> shape[2]; // each group's length; the groups themselves are freed at once
+            for (int e = 0; e < 2; e++) {
+                stores[e].blockFrames(b, boosted[e]);
+                auto start = bench_clock::now();
+                auto result = processEvents(stores[e], b, groups);
+                process[e] += secondsSince(start);
+                for (const auto& group : result) {
+                    shape[e].push_back(group.size());
+                }
+            }
+            for (int f = 0; f < frames; f++) {
+                same_shape = same_shape && boosted[0][f].size() == boosted[1][f].size();
+                for (size_t k = 0; same_shape && k < boosted[0][f].size(); k++) {
+                    float a = boosted[0][f][k], c = boosted[1][f][k];
+                    max_difference = std::max(max_difference, std::fabs(a - c) / std::max(1.0f, std::fabs(a)));
+                }
+            }
+            same_shape = same_shape && shape[0] == shape[1];
+        }
+        times[0][2] = process[0];
+        times[1][2] = process[1];
+
+        std::cout << "  " << (moving ? "one block moving" : "all at rest") << ": " << stores[1].events() << " events stored of "
+                  << stores[0].events() << " (" << stores[1].elidedEvents() << " in " << stores[1].staticRuns()
+                  << " static runs), " << (stores[0].bytes() >> 10) << " KB -> " << (stores[1].bytes() >> 10) << " KB in chunks"
+                  << std::endl;
+        const char* stages[3] = {"capture", "transform", "processEvents"};
+        for (int i = 0; i < 3; i++) {
+            std::cout << "    " << stages[i] << ": plain " << times[0][i] * 1e3 << " ms, elided " << times[1][i] * 1e3
+                      << " ms" << std::endl;
+        }
+        std::cout << "    " << (same_shape ? "same groups" : "DIFFERENT groups") << ", max relative difference "
+                  << max_difference << std::endl;
+    }
+}
+
+static bool sameFile(const std::string& a, const std::string& b) {
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    std::vector<char> da((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>());
+    std::vector<char> db((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+    return fa.good() == fb.good() && !da.empty() && da == db;
+}
+
+// Saving the capture three ways: the whole history rewritten every frame, saveBlockFrames at
+// exit, and CaptureWriter streaming each frame; worst frame stalls and whether the files match
+static void benchCaptureWriter() {
+    const int frames = 2000; // rewriting every frame is quadratic, so a short session
+    const int groups = 9;
+    std::vector<float> coordinates = randomEvents(3 * groups);
+
+    // dads: the whole history rewritten for every block on every frame
+    std::vector<std::vector<float>> history[3];
+    double rewrite_worst = 0;
+    auto start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        auto frame_start = bench_clock::now();
+        for (int b = 0; b < 3; b++) {
+            history[b].emplace_back(coordinates.begin() + b * groups * 4, coordinates.begin() + (b + 1) * groups * 4);
+            saveVector(history[b], "boost_bench_rewrite.bin");
+        }
+        rewrite_worst = std::max(rewrite_worst, secondsSince(frame_start));
+    }
+    double rewrite = secondsSince(start);
+
+    // main: the store written once per block at exit, which the render loop waited on
+    EventStore store;
+    for (int f = 0; f < frames; f++) {
+        store.beginFrame(3 * groups);
+        for (int g = 0; g < 3 * groups; g++) {
+            coordinates[g * 4] = f / 30.0f;
+        }
+        for (int b = 0; b < 3; b++) {
+            store.appendRows(b, coordinates.data() + b * groups * 4, groups);
+        }
+    }
+    start = bench_clock::now();
+    for (int b = 0; b < 3; b++) {
+        store.saveBlockFrames(b, "boost_bench_saved" + std::to_string(b) + ".bin");
+    }
+    double at_exit = secondsSince(start);
+
+    std::vector<std::string> files;
+    for (int b = 0; b < 3; b++) {
+        files.push_back("boost_bench_streamed" + std::to_string(b) + ".bin");
+    }
+    double write_worst = 0;
+    start = bench_clock::now();
+    CaptureWriter writer(files);
+    for (int f = 0; f < frames; f++) {
+        auto frame_start = bench_clock::now();
+        for (int g = 0; g < 3 * groups; g++) {
+            coordinates[g * 4] = f / 30.0f;
+        }
+        for (int b = 0; b < 3; b++) {
+            writer.write(b, coordinates.data() + b * groups * 4, groups * 4);
+        }
+        write_worst = std::max(write_worst, secondsSince(frame_start));
+    }
+    double streamed = secondsSince(start);
+    auto close_start = bench_clock::now();
+    writer.close();
+    double close = secondsSince(close_start);
+
+    bool same = true;
+    for (int b = 0; b < 3; b++) {
+        same = same && sameFile(files[b], "boost_bench_saved" + std::to_string(b) + ".bin");
+        std::remove(files[b].c_str());
+        std::remove(("boost_bench_saved" + std::to_string(b) + ".bin").c_str());
+    }
+    std::remove("boost_bench_rewrite.bin");
+
+    std::cout << "capture writer (3 blocks x " << frames << " frames of " << groups << " events)" << std::endl;
+    std::cout << "  rewrite every frame: " << rewrite * 1e3 << " ms, worst frame " << rewrite_worst * 1e3 << " ms" << std::endl;
+    std::cout << "  saveBlockFrames at exit: " << at_exit * 1e3 << " ms" << std::endl;
+    std::cout << "  streamed: " << streamed * 1e3 << " ms on the capture thread, worst frame " << write_worst * 1e6
+              << " us, close " << close * 1e3 << " ms, backlog peak " << writer.backlogPeak() << ", "
+              << (same ? "files match saveBlockFrames" : "files DIFFER from saveBlockFrames") << std::endl;
+}
+
+// The capture loop's per-block temporaries (insert_t rows, a pts_to_vertices mesh) from
+// malloc/new[] against a FrameArena reset every frame
+static void benchFrameArena() {
+    const int frames = 1 << 16;
+    const int groups = 9;
+    std::vector<float> corners = randomEvents(groups);
+    corners.resize(groups * 3); // 9 (x,y,z) groups: center, then 8 corners
+
+    // The capture loop's temporaries per block: insert_t rows and a pts_to_vertices mesh
+    double checksum_heap = 0, checksum_arena = 0;
+    auto start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        for (int b = 0; b < 3; b++) {
+            float* rows = insert_t<float>(corners.data(), groups, f / 30.0f);
+            float* mesh = pts_to_vertices(corners.data() + 3, 4);
+            checksum_heap += rows[f % (groups * 4)] + mesh[f % CUBE_MESH_FLOATS];
+            free(rows);
+            delete[] mesh;
+        }
+    }
+    double heap = secondsSince(start);
+
+    FrameArena arena;
+    start = bench_clock::now();
+    for (int f = 0; f < frames; f++) {
+        for (int b = 0; b < 3; b++) {
+            float* rows = insert_t<float>(corners.data(), groups, f / 30.0f, arena);
+            float* mesh = pts_to_vertices(corners.data() + 3, 4, arena);
+            checksum_arena += rows[f % (groups * 4)] + mesh[f % CUBE_MESH_FLOATS];
+        }
+        arena.reset();
+    }
+    double bumped = secondsSince(start);
+
+    std::cout << "frame arena (3 blocks x " << frames << " frames)" << std::endl;
+    std::cout << "  malloc/new[]: " << heap * 1e3 << " ms, arena: " << bumped * 1e3 << " ms (" << heap / bumped
+              << "x), " << arena.peakBytes() << " bytes in " << arena.peakAllocations() << " allocations per frame, "
+              << arena.heapAllocations() << " heap blocks in total, "
+              << (checksum_heap == checksum_arena ? "same values" : "DIFFERENT values") << std::endl;
+}
+
+// Two hours of 3 moving blocks sampled into an EventStore every frame against recorded as
+// Worldlines segments: memory, capture and boost time, and how far the observed worldline is off
+static void benchWorldlines() {
+    const int frames = 2 * 3600 * 30; // two hours at 30 FPS
+    const int change_every = 10 * 30; // a new velocity every 10 s
+    const float observer[3] = {0.57f, 0.1f, 0.0f};
+    std::vector<float> body = randomEvents(8);
+    body.resize(8 * 3);
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> speed(-0.3f, 0.3f);
+
+    // Sampled capture: center and 8 corners of 3 blocks every frame
+    EventStore store;
+    Worldlines worldlines;
+    float position[3][3] = {}, velocity[3][3] = {};
+    for (int b = 0; b < 3; b++) {
+        worldlines.addBlock(body.data(), 8);
+    }
+    double sampled_capture = 0, recorded_capture = 0;
+    std::vector<float> rows(9 * 4);
+    for (int f = 0; f < frames; f++) {
+        float t = f / 30.0f;
+        if (f % change_every == 0) {
+            for (int b = 0; b < 3; b++) {
+                for (int i = 0; i < 3; i++) {
+                    velocity[b][i] = speed(rng);
+                }
+            }
+        }
+        auto start = bench_clock::now();
+        store.beginFrame(27);
+        for (int b = 0; b < 3; b++) {
+            for (int k = 0; k < 9; k++) {
+                rows[k * 4] = t;
+                for (int i = 0; i < 3; i++) {
+                    rows[k * 4 + 1 + i] = position[b][i] + (k == 0 ? 0 : body[(k - 1) * 3 + i]);
+                }
+            }
+            store.appendRows(b, rows.data(), 9);
+        }
+        auto middle = bench_clock::now();
+        for (int b = 0; b < 3; b++) {
+            worldlines.record(b, t, position[b], velocity[b]);
+        }
+        auto end = bench_clock::now();
+        sampled_capture += std::chrono::duration<double>(middle - start).count();
+        recorded_capture += std::chrono::duration<double>(end - middle).count();
+        for (int b = 0; b < 3; b++) {
+            for (int i = 0; i < 3; i++) {
+                position[b][i] += velocity[b][i] / 30.0f;
+            }
+        }
+    }
+
+    Mat4 boost;
+    getBoostMat4(observer, boost);
+    auto start = bench_clock::now();
+    store.transform(boost);
+    double sampled_transform = secondsSince(start);
+    Worldlines observed;
+    start = bench_clock::now();
+    BoostStatus status = worldlines.observe(observer, observed);
+    double observe = secondsSince(start);
+
+    // Centers regenerated from the lab worldline and boosted one by one should sit on the
+    // observed worldline at their boosted times
+    std::vector<std::vector<float>> lab_frames;
+    worldlines.sampleFrames(0, 1 / 30.0f, lab_frames);
+    float max_error = 0;
+    std::vector<float> sample((1 + 8) * 4);
+    for (const std::vector<float>& frame : lab_frames) {
+        float center[4];
+        boostEvents(boost, frame.data(), center, 1);
+        if (!observed.sample(0, center[0], sample.data())) {
+            continue; // past the observed end, which the last corner may not reach
+        }
+        for (int i = 1; i < 4; i++) {
+            max_error = std::max(max_error, std::fabs(sample[i] - center[i]) / std::max(1.0f, std::fabs(center[i])));
+        }
+    }
+
+    std::cout << "worldlines (3 blocks x " << frames << " frames, velocity change every " << change_every << " frames)" << std::endl;
+    std::cout << "  sampled: " << store.bytes() << " bytes, capture " << sampled_capture * 1e3 << " ms, transform "
+              << sampled_transform * 1e3 << " ms" << std::endl;
+    std::cout << "  worldlines: " << worldlines.segments() << " segments, " << worldlines.bytes() << " bytes, capture "
+              << recorded_capture * 1e3 << " ms, observe " << observe * 1e3 << " ms"
+              << (status == BOOST_OK ? "" : " FAILED") << ", " << lab_frames.size()
+              << " frames regenerated, max relative center error " << max_error << std::endl;
+}
+
+// A block moving at constant velocity, captured every 8th step of a 240 Hz clock (or every
+// rendered frame, integrating the frame time as main used to), under a jittery render rate
+static std::vector<double> simulateCapture(double render_hz, unsigned seed, bool fixed_step, double seconds) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> jitter(0.7, 1.3);
+    SimClock clock(240);
+    double wall = 0, position = 0;
+    const double velocity = 0.37;
+    std::vector<double> captured;
+    while (wall < seconds) {
+        double frame = jitter(rng) / render_hz;
+        wall += frame;
+        if (!fixed_step) {
+            position += velocity * frame;
+            captured.insert(captured.end(), {wall, position});
+            continue;
+        }
+        for (int due = clock.advance(frame); due > 0; due--) {
+            clock.tick();
+            position += velocity * clock.step();
+            if (clock.steps() % 8 == 0) {
+                captured.insert(captured.end(), {clock.time(), position});
+            }
+        }
+    }
+    return captured;
+}
+
+// Capture driven by the render frame time against a fixed-step SimClock under jittered 30, 60
+// and 144 FPS renders, and how fast the clock steps headless
+static void benchSimClock() {
+    const double seconds = 600;
+    std::vector<double> variable30 = simulateCapture(30, 1, false, seconds);
+    std::vector<double> variable144 = simulateCapture(144, 2, false, seconds);
+    std::vector<double> fixed30 = simulateCapture(30, 1, true, seconds);
+    std::vector<double> fixed144 = simulateCapture(144, 2, true, seconds);
+    std::vector<double> fixed60 = simulateCapture(60, 3, true, seconds);
+    size_t common = std::min({fixed30.size(), fixed144.size(), fixed60.size()});
+    bool identical = std::equal(fixed30.begin(), fixed30.begin() + common, fixed144.begin())
+                     && std::equal(fixed30.begin(), fixed30.begin() + common, fixed60.begin());
+
+    SimClock headless(240);
+    const uint64_t steps = 100000000;
+    double position = 0;
+    auto start = bench_clock::now();
+    for (uint64_t s = 0; s < steps; s++) {
+        headless.tick();
+        position += 0.37 * headless.step();
+    }
+    double elapsed = secondsSince(start);
+
+    std::cout << "sim clock (" << seconds << " s at 240 Hz, jittered render)" << std::endl;
+    std::cout << "  frame-time capture: " << variable30.size() / 2 << " samples at 30 FPS, " << variable144.size() / 2
+              << " at 144" << std::endl;
+    std::cout << "  fixed-step capture: " << fixed30.size() / 2 << " / " << fixed144.size() / 2 << " / " << fixed60.size() / 2
+              << " samples at 30/144/60 FPS, first " << common / 2 << (identical ? " bit-identical" : " DIFFER") << std::endl;
+    std::cout << "  headless: " << steps / elapsed / 240 << "x real time (" << position << ")" << std::endl;
+}
+
+int main() {
+    benchBoostBuilders();
+    benchRotations();
+    benchBoostKernels();
+    benchBoostCache();
+    benchScalarTypes();
+    validateRapidity();
+    validateComposition();
+    benchTransformFrames();
+    benchMultiObserver();
+    benchReplayVertices();
+    benchIntervalValidation();
+    benchCompactHistory();
+    benchRigidBlocks();
+    benchAxisBoost();
+    benchEventStore();
+    benchStoreTransform();
+    benchStoreObservers();
+    benchEventSpill();
+    benchStaticElision();
+    benchStoreVertices();
+    benchCaptureWriter();
+    benchFrameArena();
+    benchWorldlines();
+    benchSimClock();
+    if (failures) {
+        std::cerr << failures << " checks failed" << std::endl;
+    }
+    return failures ? 1 : 0;
+}
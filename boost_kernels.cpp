@@ -0,0 +1,1083 @@
+#include "boost_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BOOST_KERNELS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+
+// Scalar fallback
+template<typename T>
+static void boostEventsScalar(const Mat4T<T>& boost, const T* events, T* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const T* e = events + i * 4;
+        T t = e[0], x = e[1], y = e[2], z = e[3];
+        for (int r = 0; r < 4; r++) {
+            out[i * 4 + r] = boost.m[r][0] * t + boost.m[r][1] * x + boost.m[r][2] * y + boost.m[r][3] * z;
+        }
+    }
+}
+
+// Boost along coordinate AXIS: only t and that coordinate change
+template<int AXIS, typename T>
+static void boostEventsAxisScalar(const Mat4T<T>& boost, const T* events, T* out, size_t count) {
+    T tt = boost.m[0][0], ta = boost.m[0][AXIS], at = boost.m[AXIS][0], aa = boost.m[AXIS][AXIS];
+    for (size_t i = 0; i < count; i++) {
+        const T* e = events + i * 4;
+        T t = e[0], a = e[AXIS];
+        for (int r = 1; r < 4; r++) {
+            out[i * 4 + r] = e[r];
+        }
+        out[i * 4] = tt * t + ta * a;
+        out[i * 4 + AXIS] = at * t + aa * a;
+    }
+}
+
+// Column kernels for boostColumns, in strips of COLUMN_STRIP events: inlined with that
+// constant trip count the loops vectorize at -O2, where a count known only at run time
+// would leave them scalar. Same arithmetic, in the same order, as boostEventsScalar.
+static const size_t COLUMN_STRIP = 16;
+
+template<typename T>
+static inline void boostColumnStrip(const Mat4T<T>& boost, T* __restrict t, T* __restrict x, T* __restrict y,
+                                    T* __restrict z, size_t n) {
+    const T m00 = boost.m[0][0], m01 = boost.m[0][1], m02 = boost.m[0][2], m03 = boost.m[0][3];
+    const T m10 = boost.m[1][0], m11 = boost.m[1][1], m12 = boost.m[1][2], m13 = boost.m[1][3];
+    const T m20 = boost.m[2][0], m21 = boost.m[2][1], m22 = boost.m[2][2], m23 = boost.m[2][3];
+    const T m30 = boost.m[3][0], m31 = boost.m[3][1], m32 = boost.m[3][2], m33 = boost.m[3][3];
+    for (size_t i = 0; i < n; i++) {
+        T et = t[i], ex = x[i], ey = y[i], ez = z[i];
+        t[i] = m00 * et + m01 * ex + m02 * ey + m03 * ez;
+        x[i] = m10 * et + m11 * ex + m12 * ey + m13 * ez;
+        y[i] = m20 * et + m21 * ex + m22 * ey + m23 * ez;
+        z[i] = m30 * et + m31 * ex + m32 * ey + m33 * ez;
+    }
+}
+
+// Along AXIS only t and a, that coordinate's column, change
+template<int AXIS, typename T>
+static inline void boostColumnStripAxis(const Mat4T<T>& boost, T* __restrict t, T* __restrict a, size_t n) {
+    const T tt = boost.m[0][0], ta = boost.m[0][AXIS], at = boost.m[AXIS][0], aa = boost.m[AXIS][AXIS];
+    for (size_t i = 0; i < n; i++) {
+        T et = t[i], ea = a[i];
+        t[i] = tt * et + ta * ea;
+        a[i] = at * et + aa * ea;
+    }
+}
+
+template<typename T>
+static void boostColumnsGeneral(const Mat4T<T>& boost, T* t, T* x, T* y, T* z, size_t count) {
+    size_t i = 0;
+    for (; i + COLUMN_STRIP <= count; i += COLUMN_STRIP) {
+        boostColumnStrip(boost, t + i, x + i, y + i, z + i, COLUMN_STRIP);
+    }
+    if (i < count) {
+        boostColumnStrip(boost, t + i, x + i, y + i, z + i, count - i);
+    }
+}
+
+template<int AXIS, typename T>
+static void boostColumnsAxis(const Mat4T<T>& boost, T* t, T* a, size_t count) {
+    size_t i = 0;
+    for (; i + COLUMN_STRIP <= count; i += COLUMN_STRIP) {
+        boostColumnStripAxis<AXIS>(boost, t + i, a + i, COLUMN_STRIP);
+    }
+    if (i < count) {
+        boostColumnStripAxis<AXIS>(boost, t + i, a + i, count - i);
+    }
+}
+
+// Register-blocked multi-observer kernels: each event is loaded (and, in SIMD, split into
+// its t/x/y/z broadcasts) once, then every boost of a block of up to MULTI_BLOCK observers
+// is applied to it. Per observer the arithmetic is the single-observer kernel's, in the same
+// order, so outs[k] is bit for bit what boostEvents gives.
+static const size_t MULTI_BLOCK = 4;
+
+template<typename T>
+static void boostEventsMultiScalar(const Mat4T<T>* boosts, size_t boost_count, const T* events, T* const* outs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const T* e = events + i * 4;
+        T t = e[0], x = e[1], y = e[2], z = e[3];
+        for (size_t k = 0; k < boost_count; k++) {
+            const Mat4T<T>& boost = boosts[k];
+            for (int r = 0; r < 4; r++) {
+                outs[k][i * 4 + r] = boost.m[r][0] * t + boost.m[r][1] * x + boost.m[r][2] * y + boost.m[r][3] * z;
+            }
+        }
+    }
+}
+
+// Interval of the separation of each disjoint event pair (2p, 2p + 1)
+template<typename T>
+static void pairIntervalsScalar(const T* events, T* intervals, T* norms, size_t pair_count) {
+    for (size_t p = 0; p < pair_count; p++) {
+        const T* a = events + p * 8;
+        const T* b = a + 4;
+        T dt = b[0] - a[0], dx = b[1] - a[1], dy = b[2] - a[2], dz = b[3] - a[3];
+        intervals[p] = dt * dt - dx * dx - dy * dy - dz * dz;
+        norms[p] = dt * dt + dx * dx + dy * dy + dz * dz;
+    }
+}
+
+// Half-precision storage. Both conversions round to nearest even, like F16C's vcvtps2ph.
+uint16_t floatToHalf(float value, HalfFormat format) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if (format == HALF_BF16) {
+        if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+            return (uint16_t)((bits >> 16) | 0x40); // keep NaN a NaN
+        }
+        return (uint16_t)((bits + 0x7FFFu + ((bits >> 16) & 1)) >> 16);
+    }
+
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if (magnitude > 0x7F800000u) {
+        return (uint16_t)(sign | 0x7E00);
+    }
+    if (magnitude >= 0x477FF000u) { // 65520 and up round past 65504
+        return (uint16_t)(sign | 0x7C00);
+    }
+    if (magnitude < 0x38800000u) { // below 2^-14: subnormal, counted in units of 2^-24
+        float scaled;
+        std::memcpy(&scaled, &magnitude, sizeof(scaled));
+        return (uint16_t)(sign | (uint16_t)std::nearbyint(scaled * 16777216.0f));
+    }
+    uint32_t half = (magnitude - 0x38000000u) >> 13; // exponent bias 127 -> 15
+    uint32_t dropped = magnitude & 0x1FFFu;
+    if (dropped > 0x1000u || (dropped == 0x1000u && (half & 1))) {
+        half++; // a carry into the exponent is still the right rounding
+    }
+    return (uint16_t)(sign | half);
+}
+
+float halfToFloat(uint16_t value, HalfFormat format) {
+    uint32_t bits;
+    if (format == HALF_BF16) {
+        bits = (uint32_t)value << 16;
+    } else {
+        uint32_t sign = (uint32_t)(value & 0x8000u) << 16;
+        uint32_t exponent = (value >> 10) & 0x1Fu;
+        uint32_t mantissa = value & 0x3FFu;
+        if (exponent == 0x1F) {
+            bits = sign | 0x7F800000u | (mantissa << 13);
+        } else if (exponent != 0) {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        } else {
+            float subnormal = std::ldexp((float)mantissa, -24); // exact, and covers zero
+            return sign ? -subnormal : subnormal;
+        }
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+static void boostHalfEventsScalar(const Mat4& boost, const uint16_t* events, HalfFormat format, const float* origin, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float e[4];
+        for (int k = 0; k < 4; k++) {
+            e[k] = origin[k] + halfToFloat(events[i * 4 + k], format);
+        }
+        for (int r = 0; r < 4; r++) {
+            out[i * 4 + r] = boost.m[r][0] * e[0] + boost.m[r][1] * e[1] + boost.m[r][2] * e[2] + boost.m[r][3] * e[3];
+        }
+    }
+}
+
+#ifdef BOOST_KERNELS_X86
+
+// Each event is one 4-wide vector, so out = col0 * t + col1 * x + col2 * y + col3 * z
+// with the columns of the boost matrix loaded once up front.
+
+// SSE2: one event per register
+__attribute__((target("sse2")))
+static void boostEventsSSE2(const Mat4& boost, const float* events, float* out, size_t count) {
+    __m128 c0 = _mm_set_ps(boost.m[3][0], boost.m[2][0], boost.m[1][0], boost.m[0][0]);
+    __m128 c1 = _mm_set_ps(boost.m[3][1], boost.m[2][1], boost.m[1][1], boost.m[0][1]);
+    __m128 c2 = _mm_set_ps(boost.m[3][2], boost.m[2][2], boost.m[1][2], boost.m[0][2]);
+    __m128 c3 = _mm_set_ps(boost.m[3][3], boost.m[2][3], boost.m[1][3], boost.m[0][3]);
+
+    for (size_t i = 0; i < count; i++) {
+        __m128 e = _mm_loadu_ps(events + i * 4);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(e, e, 0x00));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(e, e, 0x55)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(e, e, 0xAA)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(e, e, 0xFF)));
+        _mm_storeu_ps(out + i * 4, r);
+    }
+}
+
+// AVX2 + FMA: two events per register, four per iteration
+__attribute__((target("avx2,fma")))
+static void boostEventsAVX2(const Mat4& boost, const float* events, float* out, size_t count) {
+    __m256 c0 = _mm256_setr_ps(boost.m[0][0], boost.m[1][0], boost.m[2][0], boost.m[3][0],
+                               boost.m[0][0], boost.m[1][0], boost.m[2][0], boost.m[3][0]);
+    __m256 c1 = _mm256_setr_ps(boost.m[0][1], boost.m[1][1], boost.m[2][1], boost.m[3][1],
+                               boost.m[0][1], boost.m[1][1], boost.m[2][1], boost.m[3][1]);
+    __m256 c2 = _mm256_setr_ps(boost.m[0][2], boost.m[1][2], boost.m[2][2], boost.m[3][2],
+                               boost.m[0][2], boost.m[1][2], boost.m[2][2], boost.m[3][2]);
+    __m256 c3 = _mm256_setr_ps(boost.m[0][3], boost.m[1][3], boost.m[2][3], boost.m[3][3],
+                               boost.m[0][3], boost.m[1][3], boost.m[2][3], boost.m[3][3]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256 a = _mm256_loadu_ps(events + i * 4);
+        __m256 b = _mm256_loadu_ps(events + i * 4 + 8);
+        __m256 ra = _mm256_mul_ps(c0, _mm256_permute_ps(a, 0x00));
+        __m256 rb = _mm256_mul_ps(c0, _mm256_permute_ps(b, 0x00));
+        ra = _mm256_fmadd_ps(c1, _mm256_permute_ps(a, 0x55), ra);
+        rb = _mm256_fmadd_ps(c1, _mm256_permute_ps(b, 0x55), rb);
+        ra = _mm256_fmadd_ps(c2, _mm256_permute_ps(a, 0xAA), ra);
+        rb = _mm256_fmadd_ps(c2, _mm256_permute_ps(b, 0xAA), rb);
+        ra = _mm256_fmadd_ps(c3, _mm256_permute_ps(a, 0xFF), ra);
+        rb = _mm256_fmadd_ps(c3, _mm256_permute_ps(b, 0xFF), rb);
+        _mm256_storeu_ps(out + i * 4, ra);
+        _mm256_storeu_ps(out + i * 4 + 8, rb);
+    }
+    // Tail in 128-bit VEX code. Calling the legacy-SSE kernel here with the upper halves
+    // dirty costs an SSE/AVX state transition, ~140 ns per call on small frames.
+    __m128 h0 = _mm256_castps256_ps128(c0), h1 = _mm256_castps256_ps128(c1);
+    __m128 h2 = _mm256_castps256_ps128(c2), h3 = _mm256_castps256_ps128(c3);
+    for (; i < count; i++) {
+        __m128 e = _mm_loadu_ps(events + i * 4);
+        __m128 r = _mm_mul_ps(h0, _mm_permute_ps(e, 0x00));
+        r = _mm_fmadd_ps(h1, _mm_permute_ps(e, 0x55), r);
+        r = _mm_fmadd_ps(h2, _mm_permute_ps(e, 0xAA), r);
+        r = _mm_fmadd_ps(h3, _mm_permute_ps(e, 0xFF), r);
+        _mm_storeu_ps(out + i * 4, r);
+    }
+}
+
+// AVX-512: four events per register, masked tail
+__attribute__((target("avx512f")))
+static void boostEventsAVX512(const Mat4& boost, const float* events, float* out, size_t count) {
+    // Column k of the boost repeated in all four 128-bit lanes. Transposed in registers:
+    // scalar stores to a column array reloaded 64 bytes wide miss store forwarding, which
+    // cost ~40 ns per call. The zero-masked broadcast avoids GCC's uninitialised warning.
+    __m128 r0 = _mm_loadu_ps(boost.m[0]), r1 = _mm_loadu_ps(boost.m[1]);
+    __m128 r2 = _mm_loadu_ps(boost.m[2]), r3 = _mm_loadu_ps(boost.m[3]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    __m512 c0 = _mm512_maskz_broadcast_f32x4(0xFFFF, r0);
+    __m512 c1 = _mm512_maskz_broadcast_f32x4(0xFFFF, r1);
+    __m512 c2 = _mm512_maskz_broadcast_f32x4(0xFFFF, r2);
+    __m512 c3 = _mm512_maskz_broadcast_f32x4(0xFFFF, r3);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m512 e = _mm512_loadu_ps(events + i * 4);
+        __m512 r = _mm512_mul_ps(c0, _mm512_shuffle_ps(e, e, 0x00));
+        r = _mm512_fmadd_ps(c1, _mm512_shuffle_ps(e, e, 0x55), r);
+        r = _mm512_fmadd_ps(c2, _mm512_shuffle_ps(e, e, 0xAA), r);
+        r = _mm512_fmadd_ps(c3, _mm512_shuffle_ps(e, e, 0xFF), r);
+        _mm512_storeu_ps(out + i * 4, r);
+    }
+    if (i < count) {
+        __mmask16 mask = (__mmask16)((1u << ((count - i) * 4)) - 1);
+        __m512 e = _mm512_maskz_loadu_ps(mask, events + i * 4);
+        __m512 r = _mm512_mul_ps(c0, _mm512_shuffle_ps(e, e, 0x00));
+        r = _mm512_fmadd_ps(c1, _mm512_shuffle_ps(e, e, 0x55), r);
+        r = _mm512_fmadd_ps(c2, _mm512_shuffle_ps(e, e, 0xAA), r);
+        r = _mm512_fmadd_ps(c3, _mm512_shuffle_ps(e, e, 0xFF), r);
+        _mm512_mask_storeu_ps(out + i * 4, mask, r);
+    }
+}
+
+// Double precision: an event is 256 bits, so each register holds half as many events
+// as the float kernels above.
+
+// SSE2: each event split into (t,x) and (y,z) halves
+__attribute__((target("sse2")))
+static void boostEventsSSE2(const Mat4d& boost, const double* events, double* out, size_t count) {
+    __m128d lo[4], hi[4];
+    for (int k = 0; k < 4; k++) {
+        lo[k] = _mm_setr_pd(boost.m[0][k], boost.m[1][k]);
+        hi[k] = _mm_setr_pd(boost.m[2][k], boost.m[3][k]);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        __m128d tx = _mm_loadu_pd(events + i * 4);
+        __m128d yz = _mm_loadu_pd(events + i * 4 + 2);
+        __m128d t = _mm_unpacklo_pd(tx, tx), x = _mm_unpackhi_pd(tx, tx);
+        __m128d y = _mm_unpacklo_pd(yz, yz), z = _mm_unpackhi_pd(yz, yz);
+        __m128d rlo = _mm_add_pd(_mm_add_pd(_mm_mul_pd(lo[0], t), _mm_mul_pd(lo[1], x)),
+                                 _mm_add_pd(_mm_mul_pd(lo[2], y), _mm_mul_pd(lo[3], z)));
+        __m128d rhi = _mm_add_pd(_mm_add_pd(_mm_mul_pd(hi[0], t), _mm_mul_pd(hi[1], x)),
+                                 _mm_add_pd(_mm_mul_pd(hi[2], y), _mm_mul_pd(hi[3], z)));
+        _mm_storeu_pd(out + i * 4, rlo);
+        _mm_storeu_pd(out + i * 4 + 2, rhi);
+    }
+}
+
+// AVX2 + FMA: one event per register, two per iteration
+__attribute__((target("avx2,fma")))
+static void boostEventsAVX2(const Mat4d& boost, const double* events, double* out, size_t count) {
+    __m256d c0 = _mm256_setr_pd(boost.m[0][0], boost.m[1][0], boost.m[2][0], boost.m[3][0]);
+    __m256d c1 = _mm256_setr_pd(boost.m[0][1], boost.m[1][1], boost.m[2][1], boost.m[3][1]);
+    __m256d c2 = _mm256_setr_pd(boost.m[0][2], boost.m[1][2], boost.m[2][2], boost.m[3][2]);
+    __m256d c3 = _mm256_setr_pd(boost.m[0][3], boost.m[1][3], boost.m[2][3], boost.m[3][3]);
+
+    for (size_t i = 0; i < count; i++) {
+        __m256d e = _mm256_loadu_pd(events + i * 4);
+        __m256d r = _mm256_mul_pd(c0, _mm256_permute4x64_pd(e, 0x00));
+        r = _mm256_fmadd_pd(c1, _mm256_permute4x64_pd(e, 0x55), r);
+        r = _mm256_fmadd_pd(c2, _mm256_permute4x64_pd(e, 0xAA), r);
+        r = _mm256_fmadd_pd(c3, _mm256_permute4x64_pd(e, 0xFF), r);
+        _mm256_storeu_pd(out + i * 4, r);
+    }
+}
+
+// AVX-512: two events per register. The masked permute (full mask) is the same
+// instruction as _mm512_permutex_pd without GCC's uninitialised-register warning.
+#define PERMUTE_EVENT(e, imm) _mm512_mask_permutex_pd((e), 0xFF, (e), (imm))
+
+__attribute__((target("avx512f")))
+static void boostEventsAVX512(const Mat4d& boost, const double* events, double* out, size_t count) {
+    // Column k of the boost repeated in both 256-bit halves, transposed in registers
+    // like the float kernel
+    __m256d r0 = _mm256_loadu_pd(boost.m[0]), r1 = _mm256_loadu_pd(boost.m[1]);
+    __m256d r2 = _mm256_loadu_pd(boost.m[2]), r3 = _mm256_loadu_pd(boost.m[3]);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+    __m512d c0 = _mm512_maskz_broadcast_f64x4(0xFF, _mm256_permute2f128_pd(t0, t2, 0x20));
+    __m512d c1 = _mm512_maskz_broadcast_f64x4(0xFF, _mm256_permute2f128_pd(t1, t3, 0x20));
+    __m512d c2 = _mm512_maskz_broadcast_f64x4(0xFF, _mm256_permute2f128_pd(t0, t2, 0x31));
+    __m512d c3 = _mm512_maskz_broadcast_f64x4(0xFF, _mm256_permute2f128_pd(t1, t3, 0x31));
+
+    for (size_t i = 0; i < count; i += 2) {
+        __mmask8 mask = (i + 2 <= count) ? 0xFF : 0x0F;
+        __m512d e = _mm512_maskz_loadu_pd(mask, events + i * 4);
+        __m512d r = _mm512_mul_pd(c0, PERMUTE_EVENT(e, 0x00));
+        r = _mm512_fmadd_pd(c1, PERMUTE_EVENT(e, 0x55), r);
+        r = _mm512_fmadd_pd(c2, PERMUTE_EVENT(e, 0xAA), r);
+        r = _mm512_fmadd_pd(c3, PERMUTE_EVENT(e, 0xFF), r);
+        _mm512_mask_storeu_pd(out + i * 4, mask, r);
+    }
+}
+
+#undef PERMUTE_EVENT
+
+// Axis-aligned kernel: a boost along AXIS has zeros everywhere but column 0, column AXIS
+// and the identity on the other coordinates, so out = e * keep + col0 * t + colA * e[AXIS],
+// where keep clears lanes 0 and AXIS. Two products per event instead of four, and the same
+// result as the general kernels since the products they skip are all zero. AVX2 and
+// AVX-512 versions of this were dropped: their general kernels are bound by loads and
+// stores rather than FMAs, and halving the FMAs gained 0-9% on AVX2 and nothing on
+// AVX-512, with both losing up to 8% once the data left L2.
+
+template<int AXIS>
+static inline __m128i axisKeepMask() {
+    return _mm_setr_epi32(0, AXIS == 1 ? 0 : -1, AXIS == 2 ? 0 : -1, AXIS == 3 ? 0 : -1);
+}
+
+template<int AXIS>
+__attribute__((target("sse2")))
+static void boostEventsAxisSSE2(const Mat4& boost, const float* events, float* out, size_t count) {
+    __m128 c0 = _mm_set_ps(boost.m[3][0], boost.m[2][0], boost.m[1][0], boost.m[0][0]);
+    __m128 ca = _mm_set_ps(boost.m[3][AXIS], boost.m[2][AXIS], boost.m[1][AXIS], boost.m[0][AXIS]);
+    __m128 keep = _mm_castsi128_ps(axisKeepMask<AXIS>());
+
+    for (size_t i = 0; i < count; i++) {
+        __m128 e = _mm_loadu_ps(events + i * 4);
+        __m128 r = _mm_add_ps(_mm_and_ps(e, keep), _mm_mul_ps(c0, _mm_shuffle_ps(e, e, 0x00)));
+        r = _mm_add_ps(r, _mm_mul_ps(ca, _mm_shuffle_ps(e, e, AXIS * 0x55)));
+        _mm_storeu_ps(out + i * 4, r);
+    }
+}
+
+// Multi-observer, SSE2: the four broadcasts of an event serve every observer
+__attribute__((target("sse2")))
+static void boostEventsMultiSSE2(const Mat4* boosts, size_t boost_count, const float* events, float* const* outs, size_t count) {
+    __m128 c[MULTI_BLOCK][4];
+    for (size_t k = 0; k < boost_count; k++) {
+        for (int col = 0; col < 4; col++) {
+            c[k][col] = _mm_set_ps(boosts[k].m[3][col], boosts[k].m[2][col], boosts[k].m[1][col], boosts[k].m[0][col]);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        __m128 e = _mm_loadu_ps(events + i * 4);
+        __m128 et = _mm_shuffle_ps(e, e, 0x00), ex = _mm_shuffle_ps(e, e, 0x55);
+        __m128 ey = _mm_shuffle_ps(e, e, 0xAA), ez = _mm_shuffle_ps(e, e, 0xFF);
+        for (size_t k = 0; k < boost_count; k++) {
+            __m128 r = _mm_mul_ps(c[k][0], et);
+            r = _mm_add_ps(r, _mm_mul_ps(c[k][1], ex));
+            r = _mm_add_ps(r, _mm_mul_ps(c[k][2], ey));
+            r = _mm_add_ps(r, _mm_mul_ps(c[k][3], ez));
+            _mm_storeu_ps(outs[k] + i * 4, r);
+        }
+    }
+}
+
+// Multi-observer, AVX2 + FMA: four events per iteration as in boostEventsAVX2
+__attribute__((target("avx2,fma")))
+static void boostEventsMultiAVX2(const Mat4* boosts, size_t boost_count, const float* events, float* const* outs, size_t count) {
+    __m256 c[MULTI_BLOCK][4];
+    for (size_t k = 0; k < boost_count; k++) {
+        for (int col = 0; col < 4; col++) {
+            c[k][col] = _mm256_setr_ps(boosts[k].m[0][col], boosts[k].m[1][col], boosts[k].m[2][col], boosts[k].m[3][col],
+                                       boosts[k].m[0][col], boosts[k].m[1][col], boosts[k].m[2][col], boosts[k].m[3][col]);
+        }
+    }
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256 a = _mm256_loadu_ps(events + i * 4);
+        __m256 b = _mm256_loadu_ps(events + i * 4 + 8);
+        __m256 at = _mm256_permute_ps(a, 0x00), ax = _mm256_permute_ps(a, 0x55);
+        __m256 ay = _mm256_permute_ps(a, 0xAA), az = _mm256_permute_ps(a, 0xFF);
+        __m256 bt = _mm256_permute_ps(b, 0x00), bx = _mm256_permute_ps(b, 0x55);
+        __m256 by = _mm256_permute_ps(b, 0xAA), bz = _mm256_permute_ps(b, 0xFF);
+        for (size_t k = 0; k < boost_count; k++) {
+            __m256 ra = _mm256_mul_ps(c[k][0], at);
+            __m256 rb = _mm256_mul_ps(c[k][0], bt);
+            ra = _mm256_fmadd_ps(c[k][1], ax, ra);
+            rb = _mm256_fmadd_ps(c[k][1], bx, rb);
+            ra = _mm256_fmadd_ps(c[k][2], ay, ra);
+            rb = _mm256_fmadd_ps(c[k][2], by, rb);
+            ra = _mm256_fmadd_ps(c[k][3], az, ra);
+            rb = _mm256_fmadd_ps(c[k][3], bz, rb);
+            _mm256_storeu_ps(outs[k] + i * 4, ra);
+            _mm256_storeu_ps(outs[k] + i * 4 + 8, rb);
+        }
+    }
+    for (; i < count; i++) {
+        __m128 e = _mm_loadu_ps(events + i * 4);
+        __m128 et = _mm_permute_ps(e, 0x00), ex = _mm_permute_ps(e, 0x55);
+        __m128 ey = _mm_permute_ps(e, 0xAA), ez = _mm_permute_ps(e, 0xFF);
+        for (size_t k = 0; k < boost_count; k++) {
+            __m128 r = _mm_mul_ps(_mm256_castps256_ps128(c[k][0]), et);
+            r = _mm_fmadd_ps(_mm256_castps256_ps128(c[k][1]), ex, r);
+            r = _mm_fmadd_ps(_mm256_castps256_ps128(c[k][2]), ey, r);
+            r = _mm_fmadd_ps(_mm256_castps256_ps128(c[k][3]), ez, r);
+            _mm_storeu_ps(outs[k] + i * 4, r);
+        }
+    }
+}
+
+// Multi-observer, AVX-512: four events per register, masked tail
+__attribute__((target("avx512f")))
+static void boostEventsMultiAVX512(const Mat4* boosts, size_t boost_count, const float* events, float* const* outs, size_t count) {
+    __m512 c[MULTI_BLOCK][4];
+    for (size_t k = 0; k < boost_count; k++) {
+        __m128 r0 = _mm_loadu_ps(boosts[k].m[0]), r1 = _mm_loadu_ps(boosts[k].m[1]);
+        __m128 r2 = _mm_loadu_ps(boosts[k].m[2]), r3 = _mm_loadu_ps(boosts[k].m[3]);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        c[k][0] = _mm512_maskz_broadcast_f32x4(0xFFFF, r0);
+        c[k][1] = _mm512_maskz_broadcast_f32x4(0xFFFF, r1);
+        c[k][2] = _mm512_maskz_broadcast_f32x4(0xFFFF, r2);
+        c[k][3] = _mm512_maskz_broadcast_f32x4(0xFFFF, r3);
+    }
+    for (size_t i = 0; i < count; i += 4) {
+        __mmask16 mask = count - i >= 4 ? (__mmask16)0xFFFF : (__mmask16)((1u << ((count - i) * 4)) - 1);
+        __m512 e = _mm512_maskz_loadu_ps(mask, events + i * 4);
+        __m512 et = _mm512_shuffle_ps(e, e, 0x00), ex = _mm512_shuffle_ps(e, e, 0x55);
+        __m512 ey = _mm512_shuffle_ps(e, e, 0xAA), ez = _mm512_shuffle_ps(e, e, 0xFF);
+        for (size_t k = 0; k < boost_count; k++) {
+            __m512 r = _mm512_mul_ps(c[k][0], et);
+            r = _mm512_fmadd_ps(c[k][1], ex, r);
+            r = _mm512_fmadd_ps(c[k][2], ey, r);
+            r = _mm512_fmadd_ps(c[k][3], ez, r);
+            _mm512_mask_storeu_ps(outs[k] + i * 4, mask, r);
+        }
+    }
+}
+
+// Interval kernels: d = second event - first event, then dt^2 - |dx|^2 (the metric sign
+// applied to d * d) and dt^2 + |dx|^2 summed across each event's four lanes.
+
+// SSE2: one pair per iteration
+__attribute__((target("sse2")))
+static void pairIntervalsSSE2(const float* events, float* intervals, float* norms, size_t pair_count) {
+    const __m128 sign = _mm_setr_ps(1.0f, -1.0f, -1.0f, -1.0f);
+    for (size_t p = 0; p < pair_count; p++) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(events + p * 8 + 4), _mm_loadu_ps(events + p * 8));
+        __m128 q = _mm_mul_ps(d, d);
+        __m128 s = _mm_mul_ps(q, sign);
+        // [s0, s1, q0, q1] + [s2, s3, q2, q3], then the two halves of each
+        __m128 h = _mm_add_ps(_mm_shuffle_ps(s, q, 0x44), _mm_shuffle_ps(s, q, 0xEE));
+        h = _mm_add_ps(h, _mm_shuffle_ps(h, h, 0xB1));
+        intervals[p] = _mm_cvtss_f32(h);
+        norms[p] = _mm_cvtss_f32(_mm_shuffle_ps(h, h, 0x02));
+    }
+}
+
+// AVX2: two pairs per iteration, one per 128-bit lane
+__attribute__((target("avx2")))
+static void pairIntervalsAVX2(const float* events, float* intervals, float* norms, size_t pair_count) {
+    const __m256 sign = _mm256_setr_ps(1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f);
+    size_t p = 0;
+    for (; p + 2 <= pair_count; p += 2) {
+        __m256 a = _mm256_loadu_ps(events + p * 8);
+        __m256 b = _mm256_loadu_ps(events + p * 8 + 8);
+        __m256 d = _mm256_sub_ps(_mm256_permute2f128_ps(a, b, 0x31), _mm256_permute2f128_ps(a, b, 0x20));
+        __m256 q = _mm256_mul_ps(d, d);
+        __m256 s = _mm256_mul_ps(q, sign);
+        __m256 h = _mm256_hadd_ps(s, q);  // [s01, s23, q01, q23] per lane
+        h = _mm256_hadd_ps(h, h);         // [s, q, s, q] per lane
+        __m128 first = _mm256_castps256_ps128(h);
+        __m128 second = _mm256_extractf128_ps(h, 1);
+        intervals[p] = _mm_cvtss_f32(first);
+        norms[p] = _mm_cvtss_f32(_mm_shuffle_ps(first, first, 0x01));
+        intervals[p + 1] = _mm_cvtss_f32(second);
+        norms[p + 1] = _mm_cvtss_f32(_mm_shuffle_ps(second, second, 0x01));
+    }
+    // Odd pair in 128-bit VEX code, for the same reason as the boostEventsAVX2 tail
+    if (p < pair_count) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(events + p * 8 + 4), _mm_loadu_ps(events + p * 8));
+        __m128 q = _mm_mul_ps(d, d);
+        __m128 h = _mm_hadd_ps(_mm_mul_ps(q, _mm256_castps256_ps128(sign)), q);
+        h = _mm_hadd_ps(h, h);
+        intervals[p] = _mm_cvtss_f32(h);
+        norms[p] = _mm_cvtss_f32(_mm_shuffle_ps(h, h, 0x01));
+    }
+}
+
+// AVX-512: four pairs per iteration, results compressed out of lanes 0 and 2 of each 128-bit lane
+__attribute__((target("avx512f")))
+static void pairIntervalsAVX512(const float* events, float* intervals, float* norms, size_t pair_count) {
+    alignas(64) static const float signs[16] = {1, -1, -1, -1, 1, -1, -1, -1, 1, -1, -1, -1, 1, -1, -1, -1};
+    const __m512 sign = _mm512_load_ps(signs);
+    for (size_t p = 0; p < pair_count; p += 4) {
+        size_t pairs = pair_count - p < 4 ? pair_count - p : 4;
+        size_t floats = pairs * 8;
+        __mmask16 mask_a = (__mmask16)(floats >= 16 ? 0xFFFF : (1u << floats) - 1);
+        __mmask16 mask_b = (__mmask16)(floats >= 32 ? 0xFFFF : floats > 16 ? (1u << (floats - 16)) - 1 : 0);
+        __m512 a = _mm512_maskz_loadu_ps(mask_a, events + p * 8);
+        __m512 b = _mm512_maskz_loadu_ps(mask_b, events + p * 8 + 16);
+        // Second events of the four pairs minus the first events. Full-mask shuffles for the
+        // same reason as PERMUTE_EVENT above.
+        __m512 d = _mm512_sub_ps(_mm512_mask_shuffle_f32x4(a, 0xFFFF, a, b, 0xDD), _mm512_mask_shuffle_f32x4(a, 0xFFFF, a, b, 0x88));
+        __m512 q = _mm512_mul_ps(d, d);
+        __m512 s = _mm512_mul_ps(q, sign);
+        __m512 h = _mm512_add_ps(_mm512_shuffle_ps(s, q, 0x88), _mm512_shuffle_ps(s, q, 0xDD)); // [s01, s23, q01, q23]
+        h = _mm512_add_ps(h, _mm512_shuffle_ps(h, h, 0xB1));                                     // [s, s, q, q]
+        __mmask16 lanes = (__mmask16)((1u << (pairs * 4)) - 1);
+        _mm512_mask_compressstoreu_ps(intervals + p, lanes & 0x1111, h);
+        _mm512_mask_compressstoreu_ps(norms + p, lanes & 0x4444, h);
+    }
+}
+
+// AVX2 + FMA + F16C: the half values are widened as they are loaded, then the same
+// four-events-per-iteration body as boostEventsAVX2
+template<HalfFormat FORMAT>
+__attribute__((target("avx2,fma,f16c")))
+static void boostHalfEventsAVX2(const Mat4& boost, const uint16_t* events, const float* origin, float* out, size_t count) {
+    __m256 c0 = _mm256_setr_ps(boost.m[0][0], boost.m[1][0], boost.m[2][0], boost.m[3][0],
+                               boost.m[0][0], boost.m[1][0], boost.m[2][0], boost.m[3][0]);
+    __m256 c1 = _mm256_setr_ps(boost.m[0][1], boost.m[1][1], boost.m[2][1], boost.m[3][1],
+                               boost.m[0][1], boost.m[1][1], boost.m[2][1], boost.m[3][1]);
+    __m256 c2 = _mm256_setr_ps(boost.m[0][2], boost.m[1][2], boost.m[2][2], boost.m[3][2],
+                               boost.m[0][2], boost.m[1][2], boost.m[2][2], boost.m[3][2]);
+    __m256 c3 = _mm256_setr_ps(boost.m[0][3], boost.m[1][3], boost.m[2][3], boost.m[3][3],
+                               boost.m[0][3], boost.m[1][3], boost.m[2][3], boost.m[3][3]);
+    __m128 o = _mm_loadu_ps(origin);
+    __m256 o2 = _mm256_set_m128(o, o);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i ha = _mm_loadu_si128((const __m128i*)(events + i * 4));
+        __m128i hb = _mm_loadu_si128((const __m128i*)(events + i * 4 + 8));
+        __m256 a, b;
+        if (FORMAT == HALF_FP16) {
+            a = _mm256_cvtph_ps(ha);
+            b = _mm256_cvtph_ps(hb);
+        } else {
+            a = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(ha), 16));
+            b = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(hb), 16));
+        }
+        a = _mm256_add_ps(a, o2);
+        b = _mm256_add_ps(b, o2);
+        __m256 ra = _mm256_mul_ps(c0, _mm256_permute_ps(a, 0x00));
+        __m256 rb = _mm256_mul_ps(c0, _mm256_permute_ps(b, 0x00));
+        ra = _mm256_fmadd_ps(c1, _mm256_permute_ps(a, 0x55), ra);
+        rb = _mm256_fmadd_ps(c1, _mm256_permute_ps(b, 0x55), rb);
+        ra = _mm256_fmadd_ps(c2, _mm256_permute_ps(a, 0xAA), ra);
+        rb = _mm256_fmadd_ps(c2, _mm256_permute_ps(b, 0xAA), rb);
+        ra = _mm256_fmadd_ps(c3, _mm256_permute_ps(a, 0xFF), ra);
+        rb = _mm256_fmadd_ps(c3, _mm256_permute_ps(b, 0xFF), rb);
+        _mm256_storeu_ps(out + i * 4, ra);
+        _mm256_storeu_ps(out + i * 4 + 8, rb);
+    }
+    __m128 h0 = _mm256_castps256_ps128(c0), h1 = _mm256_castps256_ps128(c1);
+    __m128 h2 = _mm256_castps256_ps128(c2), h3 = _mm256_castps256_ps128(c3);
+    for (; i < count; i++) {
+        __m128i h = _mm_loadl_epi64((const __m128i*)(events + i * 4));
+        __m128 e = FORMAT == HALF_FP16 ? _mm_cvtph_ps(h) : _mm_castsi128_ps(_mm_slli_epi32(_mm_cvtepu16_epi32(h), 16));
+        e = _mm_add_ps(e, o);
+        __m128 r = _mm_mul_ps(h0, _mm_permute_ps(e, 0x00));
+        r = _mm_fmadd_ps(h1, _mm_permute_ps(e, 0x55), r);
+        r = _mm_fmadd_ps(h2, _mm_permute_ps(e, 0xAA), r);
+        r = _mm_fmadd_ps(h3, _mm_permute_ps(e, 0xFF), r);
+        _mm_storeu_ps(out + i * 4, r);
+    }
+}
+
+// XCR0 tells us which register state the OS actually saves on context switch
+static unsigned long long readXCR0() {
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+
+#endif // BOOST_KERNELS_X86
+
+
+BoostKernel detectBoostKernel() {
+#ifdef BOOST_KERNELS_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return BOOST_KERNEL_SCALAR;
+    }
+    bool sse2 = edx & (1u << 26);
+    bool fma = ecx & (1u << 12);
+    bool osxsave = ecx & (1u << 27);
+    bool avx = ecx & (1u << 28);
+    if (!sse2) {
+        return BOOST_KERNEL_SCALAR;
+    }
+    if (!osxsave || !avx) {
+        return BOOST_KERNEL_SSE2;
+    }
+
+    unsigned long long xcr0 = readXCR0();
+    bool ymm_state = (xcr0 & 0x6) == 0x6;    // SSE + AVX state
+    bool zmm_state = (xcr0 & 0xE6) == 0xE6;  // plus opmask and the upper zmm halves
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return BOOST_KERNEL_SSE2;
+    }
+    bool avx2 = ebx & (1u << 5);
+    bool avx512f = ebx & (1u << 16);
+
+    if (avx512f && zmm_state) {
+        return BOOST_KERNEL_AVX512;
+    }
+    if (avx2 && fma && ymm_state) {
+        return BOOST_KERNEL_AVX2;
+    }
+    return BOOST_KERNEL_SSE2;
+#else
+    return BOOST_KERNEL_SCALAR;
+#endif
+}
+
+template<typename T>
+using BoostEventsFn = void (*)(const Mat4T<T>&, const T*, T*, size_t);
+
+template<typename T>
+static BoostEventsFn<T> kernelFunction(BoostKernel kernel) {
+    switch (kernel) {
+#ifdef BOOST_KERNELS_X86
+        case BOOST_KERNEL_AVX512: return boostEventsAVX512;
+        case BOOST_KERNEL_AVX2: return boostEventsAVX2;
+        case BOOST_KERNEL_SSE2: return boostEventsSSE2;
+#endif
+        default: return boostEventsScalar<T>;
+    }
+}
+
+template<typename T>
+using PairIntervalsFn = void (*)(const T*, T*, T*, size_t);
+
+template<typename T>
+static PairIntervalsFn<T> intervalFunction(BoostKernel) {
+    return pairIntervalsScalar<T>;
+}
+
+template<>
+PairIntervalsFn<float> intervalFunction<float>(BoostKernel kernel) {
+    switch (kernel) {
+#ifdef BOOST_KERNELS_X86
+        case BOOST_KERNEL_AVX512: return pairIntervalsAVX512;
+        case BOOST_KERNEL_AVX2: return pairIntervalsAVX2;
+        case BOOST_KERNEL_SSE2: return pairIntervalsSSE2;
+#endif
+        default: return pairIntervalsScalar<float>;
+    }
+}
+
+static std::atomic<int> active_kernel{-1}; // -1 until the first call detects the CPU
+
+BoostKernel activeBoostKernel() {
+    int kernel = active_kernel.load(std::memory_order_relaxed);
+    if (kernel < 0) {
+        kernel = detectBoostKernel();
+        active_kernel.store(kernel, std::memory_order_relaxed);
+    }
+    return (BoostKernel)kernel;
+}
+
+BoostKernel setBoostKernel(BoostKernel kernel) {
+    BoostKernel supported = detectBoostKernel();
+    if (kernel > supported) {
+        kernel = supported;
+    }
+    active_kernel.store(kernel, std::memory_order_relaxed);
+    return kernel;
+}
+
+const char* boostKernelName(BoostKernel kernel) {
+    switch (kernel) {
+        case BOOST_KERNEL_AVX512: return "avx512";
+        case BOOST_KERNEL_AVX2: return "avx2";
+        case BOOST_KERNEL_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void pairIntervals(const float* events, float* intervals, float* norms, size_t pair_count) {
+    intervalFunction<float>(activeBoostKernel())(events, intervals, norms, pair_count);
+}
+
+void pairIntervals(const double* events, double* intervals, double* norms, size_t pair_count) {
+    intervalFunction<double>(activeBoostKernel())(events, intervals, norms, pair_count);
+}
+
+// Interval validation. Events are checked in blocks of INTERVAL_BLOCK; a per-thread countdown
+// picks one block in interval_stride across calls, so 9-event frames get sampled as evenly as
+// one big batch. A call samples at most INTERVAL_MAX_BLOCKS blocks, spread over the batch,
+// which keeps the check cost flat for big batches.
+static const size_t INTERVAL_BLOCK = 16; // 8 pairs
+static const size_t INTERVAL_MAX_BLOCKS = 64;
+
+// The stride is 0 while validation is off, so an unsampled call reads a single atomic
+static std::atomic<unsigned> interval_stride{BOOST_VALIDATE_INTERVALS != 0 ? 1024 : 0};
+static std::atomic<unsigned long long> interval_pairs{0};
+static std::atomic<unsigned long long> interval_events{0};
+static std::atomic<unsigned long long> interval_kernel_ticks{0};
+static std::atomic<unsigned long long> interval_check_ticks{0};
+static std::atomic<double> interval_max_error{0};
+static thread_local size_t interval_skip = 0; // blocks before the next sampled one
+
+// Checks are timed in TSC ticks on x86: a steady_clock read costs ~50 ns on some VMs, and
+// each checked call takes four, more than the check itself. Ticks become seconds when the
+// report is read, by how far both clocks have moved since startup.
+static uint64_t checkTicks() {
+#ifdef BOOST_KERNELS_X86
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static const uint64_t ticks_at_start = checkTicks();
+static const std::chrono::steady_clock::time_point clock_at_start = std::chrono::steady_clock::now();
+
+static double secondsPerTick() {
+#ifdef BOOST_KERNELS_X86
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_at_start).count();
+    uint64_t ticks = checkTicks() - ticks_at_start;
+    return ticks > 0 ? elapsed / ticks : 0;
+#else
+    return 1e-9;
+#endif
+}
+
+static void recordIntervalCheck(size_t pairs, size_t events, uint64_t kernel_ticks, uint64_t check_ticks, double max_error) {
+    interval_pairs.fetch_add(pairs, std::memory_order_relaxed);
+    interval_events.fetch_add(events, std::memory_order_relaxed);
+    interval_kernel_ticks.fetch_add(kernel_ticks, std::memory_order_relaxed);
+    interval_check_ticks.fetch_add(check_ticks, std::memory_order_relaxed);
+    double current = interval_max_error.load(std::memory_order_relaxed);
+    // NaN is kept once seen, it means a kernel produced garbage
+    while (!std::isnan(current) && !(max_error <= current) &&
+           !interval_max_error.compare_exchange_weak(current, max_error, std::memory_order_relaxed)) {
+    }
+}
+
+// Runs boost(), which boosts count events, with the pair intervals of the sampled blocks
+// measured before and after it. before and after give events [start, start + n) as packed
+// (t,x,y,z) rows, either in place or copied into the scratch they are handed.
+template<typename T, typename Before, typename After, typename Boost>
+static void boostValidated(BoostKernel kernel, size_t count, Before before_rows, After after_rows, Boost boost) {
+    uint64_t check_start = checkTicks();
+    PairIntervalsFn<T> intervals = intervalFunction<T>(kernel);
+    size_t blocks = (count + INTERVAL_BLOCK - 1) / INTERVAL_BLOCK;
+    size_t stride = interval_stride.load(std::memory_order_relaxed);
+    size_t first = interval_skip;
+    size_t step = std::max(stride, (blocks - first + INTERVAL_MAX_BLOCKS - 1) / INTERVAL_MAX_BLOCKS);
+
+    // The output may alias the input, so the sampled blocks are measured before the boost
+    T before[INTERVAL_MAX_BLOCKS * INTERVAL_BLOCK / 2], before_norms[INTERVAL_MAX_BLOCKS * INTERVAL_BLOCK / 2];
+    T scratch[INTERVAL_BLOCK * 4];
+    size_t at = 0, last = first;
+    for (size_t b = first; b < blocks; b += step) {
+        size_t start = b * INTERVAL_BLOCK;
+        size_t n = std::min(count - start, INTERVAL_BLOCK);
+        intervals(before_rows(start, n, scratch), before + at, before_norms + at, n / 2);
+        at += n / 2;
+        last = b;
+    }
+    size_t remaining = blocks - last - 1;
+    interval_skip = remaining < stride - 1 ? stride - 1 - remaining : 0;
+
+    uint64_t kernel_start = checkTicks();
+    boost();
+    uint64_t kernel_end = checkTicks();
+
+    double max_error = 0;
+    at = 0;
+    for (size_t b = first; b < blocks; b += step) {
+        size_t start = b * INTERVAL_BLOCK;
+        size_t n = std::min(count - start, INTERVAL_BLOCK);
+        T after[INTERVAL_BLOCK / 2], after_norms[INTERVAL_BLOCK / 2];
+        intervals(after_rows(start, n, scratch), after, after_norms, n / 2);
+        for (size_t p = 0; p < n / 2; p++) {
+            T scale = std::max({before_norms[at + p], after_norms[p], std::numeric_limits<T>::min()});
+            double error = std::fabs(after[p] - before[at + p]) / scale;
+            if (!(error <= max_error)) max_error = error; // lets NaN through
+        }
+        at += n / 2;
+    }
+    if (at > 0) {
+        uint64_t check_end = checkTicks();
+        recordIntervalCheck(at, count, kernel_end - kernel_start, kernel_start - check_start + (check_end - kernel_end), max_error);
+    }
+}
+
+// The countdown for a call that validation is on for: boostValidated if one of its blocks
+// is due, else boost() alone
+template<typename T, typename Before, typename After, typename Boost>
+__attribute__((noinline)) static void boostSampled(BoostKernel kernel, size_t count, size_t stride, Before before_rows,
+                                                   After after_rows, Boost boost) {
+    if (interval_skip >= stride) {
+        interval_skip = stride - 1; // left from a longer stride: setIntervalValidation cannot reach other threads' countdowns
+    }
+    size_t blocks = (count + INTERVAL_BLOCK - 1) / INTERVAL_BLOCK;
+    if (blocks > interval_skip) {
+        boostValidated<T>(kernel, count, before_rows, after_rows, boost);
+        return;
+    }
+    interval_skip -= blocks;
+    boost();
+}
+
+template<typename T>
+static void boostEventsSampled(BoostKernel kernel, const Mat4T<T>& boost, const T* events, T* out, size_t count, size_t stride) {
+    boostSampled<T>(kernel, count, stride,
+                    [events](size_t start, size_t, T*) { return events + start * 4; },
+                    [out](size_t start, size_t, T*) { return (const T*)out + start * 4; },
+                    [&] { kernelFunction<T>(kernel)(boost, events, out, count); });
+}
+
+template<typename T>
+static void boostEventsDispatch(const Mat4T<T>& boost, const T* events, T* out, size_t count) {
+    BoostKernel kernel = activeBoostKernel();
+    size_t stride = interval_stride.load(std::memory_order_relaxed);
+    if (stride != 0) {
+        // An unsampled call only counts down; everything else is kept out of line
+        size_t blocks = (count + INTERVAL_BLOCK - 1) / INTERVAL_BLOCK;
+        size_t skip = interval_skip;
+        if (blocks > skip || skip >= stride) {
+            boostEventsSampled(kernel, boost, events, out, count, stride);
+            return;
+        }
+        interval_skip = skip - blocks;
+    }
+    kernelFunction<T>(kernel)(boost, events, out, count);
+}
+
+template<typename T>
+static void boostColumnsKernel(int axis, const Mat4T<T>& boost, T* t, T* x, T* y, T* z, size_t count) {
+    switch (axis) {
+        case 1: boostColumnsAxis<1>(boost, t, x, count); break;
+        case 2: boostColumnsAxis<2>(boost, t, y, count); break;
+        case 3: boostColumnsAxis<3>(boost, t, z, count); break;
+        default: boostColumnsGeneral(boost, t, x, y, z, count); break;
+    }
+}
+
+template<typename T>
+static void boostColumnsDispatch(const Mat4T<T>& boost, T* t, T* x, T* y, T* z, size_t count) {
+    int axis = boostAxis(boost);
+    size_t stride = interval_stride.load(std::memory_order_relaxed);
+    if (stride != 0) {
+        // Sampled blocks are gathered into rows for the interval check
+        auto rows = [=](size_t start, size_t n, T* scratch) {
+            for (size_t i = 0; i < n; i++) {
+                scratch[i * 4] = t[start + i];
+                scratch[i * 4 + 1] = x[start + i];
+                scratch[i * 4 + 2] = y[start + i];
+                scratch[i * 4 + 3] = z[start + i];
+            }
+            return (const T*)scratch;
+        };
+        boostSampled<T>(activeBoostKernel(), count, stride, rows, rows,
+                        [&] { boostColumnsKernel(axis, boost, t, x, y, z, count); });
+        return;
+    }
+    boostColumnsKernel(axis, boost, t, x, y, z, count);
+}
+
+void boostColumns(const Mat4& boost, float* t, float* x, float* y, float* z, size_t count) {
+    boostColumnsDispatch(boost, t, x, y, z, count);
+}
+
+void boostColumns(const Mat4d& boost, double* t, double* x, double* y, double* z, size_t count) {
+    boostColumnsDispatch(boost, t, x, y, z, count);
+}
+
+void setIntervalValidation(bool enabled, unsigned sample_stride) {
+    interval_stride.store(enabled ? std::max(sample_stride, 1u) : 0, std::memory_order_relaxed);
+}
+
+bool intervalValidation() {
+    return interval_stride.load(std::memory_order_relaxed) != 0;
+}
+
+IntervalReport intervalReport() {
+    IntervalReport report;
+    report.pairs = interval_pairs.load(std::memory_order_relaxed);
+    report.events = interval_events.load(std::memory_order_relaxed);
+    double seconds_per_tick = secondsPerTick();
+    report.kernel_seconds = interval_kernel_ticks.load(std::memory_order_relaxed) * seconds_per_tick;
+    report.check_seconds = interval_check_ticks.load(std::memory_order_relaxed) * seconds_per_tick;
+    report.max_error = interval_max_error.load(std::memory_order_relaxed);
+    return report;
+}
+
+void resetIntervalReport() {
+    interval_pairs.store(0, std::memory_order_relaxed);
+    interval_events.store(0, std::memory_order_relaxed);
+    interval_kernel_ticks.store(0, std::memory_order_relaxed);
+    interval_check_ticks.store(0, std::memory_order_relaxed);
+    interval_max_error.store(0, std::memory_order_relaxed);
+}
+
+void boostEvents(const Mat4& boost, const float* events, float* out, size_t count) {
+    boostEventsDispatch(boost, events, out, count);
+}
+
+void boostEvents(const Mat4d& boost, const double* events, double* out, size_t count) {
+    boostEventsDispatch(boost, events, out, count);
+}
+
+// Only the kernels whose axis variant measurably wins: scalar (1.6-2.0x) and SSE2
+// (1.2-1.5x), from 9-event frames to 256K-event batches. AVX2 and AVX-512 keep the
+// general kernel.
+template<int AXIS>
+static BoostEventsFn<float> axisKernelFunction(BoostKernel kernel) {
+    switch (kernel) {
+#ifdef BOOST_KERNELS_X86
+        case BOOST_KERNEL_SSE2: return boostEventsAxisSSE2<AXIS>;
+#endif
+        default: return boostEventsAxisScalar<AXIS, float>;
+    }
+}
+
+void boostEventsAxis(int axis, const Mat4& boost, const float* events, float* out, size_t count) {
+    // Validation samples through the general path so its countdown stays per call. The raw
+    // load leaves CPU detection to that path too: a call into it here would have the AVX2 and
+    // AVX-512 calls, the ones that just pass through, save and restore registers first.
+    int kernel = active_kernel.load(std::memory_order_relaxed);
+    if (axis < 1 || axis > 3 || kernel < 0 || kernel > BOOST_KERNEL_SSE2 || intervalValidation()) {
+        boostEventsDispatch(boost, events, out, count);
+        return;
+    }
+    BoostEventsFn<float> fn = axis == 1 ? axisKernelFunction<1>((BoostKernel)kernel)
+                            : axis == 2 ? axisKernelFunction<2>((BoostKernel)kernel)
+                                        : axisKernelFunction<3>((BoostKernel)kernel);
+    fn(boost, events, out, count);
+}
+
+void boostEventsAxis(int axis, const Mat4d& boost, const double* events, double* out, size_t count) {
+    // The SIMD double kernels beat the scalar axis loop, so it only replaces the scalar one
+    if (axis < 1 || axis > 3 || activeBoostKernel() != BOOST_KERNEL_SCALAR ||
+        intervalValidation()) {
+        boostEventsDispatch(boost, events, out, count);
+        return;
+    }
+    BoostEventsFn<double> fn = axis == 1 ? boostEventsAxisScalar<1, double>
+                             : axis == 2 ? boostEventsAxisScalar<2, double>
+                                         : boostEventsAxisScalar<3, double>;
+    fn(boost, events, out, count);
+}
+
+template<typename T>
+using BoostEventsMultiFn = void (*)(const Mat4T<T>*, size_t, const T*, T* const*, size_t);
+
+static BoostEventsMultiFn<float> multiKernelFunction(BoostKernel kernel) {
+    switch (kernel) {
+#ifdef BOOST_KERNELS_X86
+        case BOOST_KERNEL_AVX512: return boostEventsMultiAVX512;
+        case BOOST_KERNEL_AVX2: return boostEventsMultiAVX2;
+        case BOOST_KERNEL_SSE2: return boostEventsMultiSSE2;
+#endif
+        default: return boostEventsMultiScalar<float>;
+    }
+}
+
+// Multi-observer boost: the history is walked in tiles small enough to stay in L2, and
+// within a tile each block of MULTI_BLOCK observers is one register-blocked pass, so memory
+// sees the input once instead of once per observer. The K outputs still have to be written,
+// which caps the gain at (K reads + K writes) / (1 read + K writes).
+static const size_t MULTI_TILE_BYTES = 65536;
+
+template<typename T>
+static void boostEventsMultiTiled(BoostEventsMultiFn<T> fn, const Mat4T<T>* boosts, size_t boost_count, const T* events, T* const* outs, size_t count) {
+    const size_t tile = MULTI_TILE_BYTES / (4 * sizeof(T));
+    for (size_t begin = 0; begin < count; begin += tile) {
+        size_t tile_count = std::min(tile, count - begin);
+        for (size_t k = 0; k < boost_count; k += MULTI_BLOCK) {
+            size_t block = std::min(MULTI_BLOCK, boost_count - k);
+            T* block_outs[MULTI_BLOCK];
+            for (size_t j = 0; j < block; j++) {
+                block_outs[j] = outs[k + j] + begin * 4;
+            }
+            if (fn) {
+                fn(boosts + k, block, events + begin * 4, block_outs, tile_count);
+            } else {
+                // No blocked kernel (validation on, or double on SIMD): one pass per observer,
+                // through the dispatch so validation samples each of them
+                for (size_t j = 0; j < block; j++) {
+                    boostEventsDispatch(boosts[k + j], events + begin * 4, block_outs[j], tile_count);
+                }
+            }
+        }
+    }
+}
+
+void boostEventsMulti(const Mat4* boosts, size_t boost_count, const float* events, float* const* outs, size_t count) {
+    BoostEventsMultiFn<float> fn = intervalValidation() ? nullptr
+                                 : multiKernelFunction(activeBoostKernel());
+    boostEventsMultiTiled(fn, boosts, boost_count, events, outs, count);
+}
+
+void boostEventsMulti(const Mat4d* boosts, size_t boost_count, const double* events, double* const* outs, size_t count) {
+    // The SIMD double kernels one observer at a time beat the register-blocked scalar loop
+    // (22 vs 30 ms for 4 x 1M events), so it only replaces the scalar kernel
+    BoostEventsMultiFn<double> fn = intervalValidation() || activeBoostKernel() != BOOST_KERNEL_SCALAR
+                                  ? nullptr : boostEventsMultiScalar<double>;
+    boostEventsMultiTiled(fn, boosts, boost_count, events, outs, count);
+}
+
+// F16C came with AVX2 and FMA on every CPU the AVX2 kernel runs on, but it has its own CPUID bit
+static bool detectF16C() {
+#ifdef BOOST_KERNELS_X86
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 29));
+#else
+    return false;
+#endif
+}
+
+void boostHalfEvents(const Mat4& boost, const uint16_t* events, HalfFormat format, const float* origin, float* out, size_t count) {
+#ifdef BOOST_KERNELS_X86
+    static const bool f16c = detectF16C();
+    if (f16c && activeBoostKernel() >= BOOST_KERNEL_AVX2) {
+        if (format == HALF_BF16) {
+            boostHalfEventsAVX2<HALF_BF16>(boost, events, origin, out, count);
+        } else {
+            boostHalfEventsAVX2<HALF_FP16>(boost, events, origin, out, count);
+        }
+        return;
+    }
+#endif
+    boostHalfEventsScalar(boost, events, format, origin, out, count);
+}
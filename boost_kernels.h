@@ -0,0 +1,92 @@
+#include <cstddef>
+#include <cstdint>
+#include "matrix_operations.h"
+
+#ifndef BOOST_KERNELS_H
+#define BOOST_KERNELS_H
+
+// Batched event boosting. Events are packed (t,x,y,z) rows, the same layout
+// transformation() takes. The widest variant the CPU supports is picked at
+// runtime through CPUID, with a scalar fallback everywhere else.
+typedef enum BoostKernel {
+    BOOST_KERNEL_SCALAR = 0,
+    BOOST_KERNEL_SSE2,
+    BOOST_KERNEL_AVX2,
+    BOOST_KERNEL_AVX512
+} BoostKernel;
+
+BoostKernel detectBoostKernel();               // best variant this CPU can run
+BoostKernel activeBoostKernel();               // variant boostEvents() currently uses
+BoostKernel setBoostKernel(BoostKernel kernel); // force a variant, clamped to what the CPU supports
+const char* boostKernelName(BoostKernel kernel);
+
+// out[i] = boost * events[i] for count events. out may alias events.
+// The double overload runs the same variant at half the events per register.
+void boostEvents(const Mat4& boost, const float* events, float* out, size_t count);
+void boostEvents(const Mat4d& boost, const double* events, double* out, size_t count);
+
+// Same as boostEvents for a boost along one coordinate axis (1 = x, 2 = y, 3 = z), as
+// boostAxis() reports: only t and that coordinate are computed, the others are copied.
+// That only pays on the scalar and SSE2 kernels; under AVX2 and AVX-512, and with axis 0,
+// this is boostEvents, so callers can pass boostAxis() straight through.
+void boostEventsAxis(int axis, const Mat4& boost, const float* events, float* out, size_t count);
+void boostEventsAxis(int axis, const Mat4d& boost, const double* events, double* out, size_t count);
+
+// boostEvents for events kept as columns (structure of arrays), boosted in place: event i
+// is (t[i], x[i], y[i], z[i]). A boost along one axis (boostAxis) only rewrites t and that
+// axis' column. Compiler-vectorized for the baseline ISA rather than dispatched on
+// BoostKernel; interval validation samples it like boostEvents.
+void boostColumns(const Mat4& boost, float* t, float* x, float* y, float* z, size_t count);
+void boostColumns(const Mat4d& boost, double* t, double* x, double* y, double* z, size_t count);
+
+// Spacetime interval check. For each disjoint pair of events (2p, 2p + 1):
+//   intervals[p] = dt^2 - dx^2 - dy^2 - dz^2, norms[p] = dt^2 + dx^2 + dy^2 + dz^2
+// A correct boost leaves intervals unchanged. SIMD for float, scalar for double.
+void pairIntervals(const float* events, float* intervals, float* norms, size_t pair_count);
+void pairIntervals(const double* events, double* intervals, double* norms, size_t pair_count);
+
+// Opt-in validation of every boostEvents call (and so transformation()). One block of 16
+// events in sample_stride is measured before and after the boost, at most 64 blocks per
+// call. A checked call costs ~200 ns whatever its size, so with the default of 1024 a
+// 9-event frame (one block) runs within 0-3% of unchecked on every kernel in quiet runs;
+// 64 cost such frames 15-35% on the SIMD kernels.
+// Build with -DBOOST_VALIDATE_INTERVALS=1 to start with it on.
+#ifndef BOOST_VALIDATE_INTERVALS
+#define BOOST_VALIDATE_INTERVALS 0
+#endif
+
+struct IntervalReport {
+    unsigned long long pairs;  // event pairs checked since the last reset
+    unsigned long long events; // events boosted by the calls that were checked
+    double kernel_seconds;     // time those calls spent in the kernel
+    double check_seconds;      // time they spent measuring intervals before and after it
+    double max_error;          // max |interval after - before| / max(norm before, after); NaN if a kernel produced NaN
+};
+
+void setIntervalValidation(bool enabled, unsigned sample_stride = 1024);
+bool intervalValidation();
+IntervalReport intervalReport();
+void resetIntervalReport();
+
+// outs[k][i] = boosts[k] * events[i] for boost_count observers in one pass over events.
+// Each outs[k] holds count events and must not alias events.
+void boostEventsMulti(const Mat4* boosts, size_t boost_count, const float* events, float* const* outs, size_t count);
+void boostEventsMulti(const Mat4d* boosts, size_t boost_count, const double* events, double* const* outs, size_t count);
+
+// Half-precision event storage: fp16 (IEEE binary16, 11-bit significand, max 65504) or
+// bf16 (fp32's exponent range with an 8-bit significand). Round to nearest even; fp16
+// values past 65504 become infinity.
+typedef enum HalfFormat {
+    HALF_FP16 = 0,
+    HALF_BF16
+} HalfFormat;
+
+uint16_t floatToHalf(float value, HalfFormat format);
+float halfToFloat(uint16_t value, HalfFormat format);
+
+// out[i] = boost * (origin + events[i]) for count events stored as four 16-bit values,
+// origin being one fp32 (t,x,y,z). Widened to fp32 in registers (F16C under the AVX2 and
+// AVX-512 kernels), so a compact history boosts without a decode pass. Not interval checked.
+void boostHalfEvents(const Mat4& boost, const uint16_t* events, HalfFormat format, const float* origin, float* out, size_t count);
+
+#endif
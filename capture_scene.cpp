@@ -0,0 +1,56 @@
+#include "capture_scene.h"
+#include "event_pipeline.h"
+
+template<typename T>
+CaptureSceneT<T>::CaptureSceneT(WorldlinesT<T>& worldlines)
+    : worldlines_(worldlines), body_(cube_vertices(9, 4, 5, 4)) {
+    std::vector<T> body_offsets(body_.begin(), body_.end());
+    for (int b = 0; b < SCENE_BLOCKS; b++) {
+        worldlines_.addBlock(body_offsets.data(), SCENE_CORNERS);
+        positions_[b][0] = -7; positions_[b][1] = 1; positions_[b][2] = 1;
+        velocities_[b][0] = velocities_[b][1] = velocities_[b][2] = 0;
+    }
+}
+
+template<typename T>
+void CaptureSceneT<T>::setVelocity(int block, const float* velocity) {
+    for (int i = 0; i < 3; i++) {
+        velocities_[block][i] = velocity[i];
+    }
+}
+
+template<typename T>
+bool CaptureSceneT<T>::step(const SimClock& clock) {
+    const float step = (float)clock.step();
+    for (int b = 0; b < SCENE_BLOCKS; b++) {
+        T center[3], center_velocity[3];
+        for (int i = 0; i < 3; i++) {
+            positions_[b][i] += velocities_[b][i] * step;
+            center[i] = positions_[b][i];
+            center_velocity[i] = velocities_[b][i];
+        }
+        worldlines_.record(b, (T)clock.time(), center, center_velocity);
+    }
+    return clock.steps() % CAPTURE_EVERY_STEPS == 0;
+}
+
+template<typename T>
+T* CaptureSceneT<T>::blockEvents(int block, T t, FrameArena& arena) const {
+    float* groups = prepend_center(body_.data(), SCENE_CORNERS, positions_[block], arena);
+    return insert_t<T>(groups, SCENE_BLOCK_EVENTS, t, arena);
+}
+
+template<typename T>
+bool CaptureSceneT<T>::captureFrame(T t, EventStoreT<T>& store, CaptureWriterT<T>& writer, FrameArena& arena) const {
+    bool written = true;
+    store.beginFrame(SCENE_BLOCKS * SCENE_BLOCK_EVENTS);
+    for (int b = 0; b < SCENE_BLOCKS; b++) {
+        T* events_array = blockEvents(b, t, arena);
+        store.appendRows(b, events_array, SCENE_BLOCK_EVENTS);
+        written = writer.write(b, events_array, SCENE_BLOCK_EVENTS * 4) && written;
+    }
+    return written;
+}
+
+template class CaptureSceneT<float>;
+template class CaptureSceneT<double>;
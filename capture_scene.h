@@ -0,0 +1,58 @@
+#include <cstdint>
+#include <vector>
+#include "event_store.h"
+#include "capture_writer.h"
+#include "frame_arena.h"
+#include "worldline.h"
+#include "sim_clock.h"
+
+#ifndef CAPTURE_SCENE_H
+#define CAPTURE_SCENE_H
+
+// The scene main.cpp captures and headless_capture runs without a window: SCENE_BLOCKS
+// 9x4x5 blocks starting at (-7, 1, 1), moved and recorded on every step of a SIM_HZ clock
+// and captured every CAPTURE_EVERY_STEPS-th step. Both programs step it through here, so
+// their capture files and worldlines come from the same code.
+// Defined in capture_scene.cpp for float and double.
+
+#define SIM_HZ 240 // simulation steps per second, whatever the render rate
+#define CAPTURE_EVERY_STEPS 8 // a captured frame every 8 steps: 30 per sim second
+
+const int SCENE_BLOCKS = 3;
+const int SCENE_CORNERS = 8;
+// (t,x,y,z) events a block contributes to a captured frame: its center, then its corners
+const int SCENE_BLOCK_EVENTS = SCENE_CORNERS + 1;
+static_assert(SCENE_BLOCK_EVENTS * 4 <= CAPTURED_FRAME_VALUES, "a block's frame must fit a CaptureWriter slot");
+
+template<typename T>
+class CaptureSceneT {
+public:
+    // Every block at rest at (-7, 1, 1) and added to worldlines, which step() records into
+    explicit CaptureSceneT(WorldlinesT<T>& worldlines);
+
+    // Lab velocity the block moves at from the next step() on
+    void setVelocity(int block, const float* velocity);
+    // Call after clock.tick(): moves every block by clock.step() and records it at
+    // clock.time(). True when this step is one to capture.
+    bool step(const SimClock& clock);
+
+    // The block's captured events at time t, in the layout insert_t gives: valid until arena's next reset()
+    T* blockEvents(int block, T t, FrameArena& arena) const;
+    // The captured frame at time t: every block's events as one frame of store, and each
+    // block's handed to writer. False if writer refused one, so its files miss this frame.
+    bool captureFrame(T t, EventStoreT<T>& store, CaptureWriterT<T>& writer, FrameArena& arena) const;
+
+    const float* position(int block) const { return positions_[block]; }
+    const float* velocity(int block) const { return velocities_[block]; }
+    const std::vector<float>& body() const { return body_; } // corner offsets from the center, 3 values each
+
+private:
+    WorldlinesT<T>& worldlines_;
+    std::vector<float> body_;
+    float positions_[SCENE_BLOCKS][3];
+    float velocities_[SCENE_BLOCKS][3];
+};
+
+using CaptureScene = CaptureSceneT<float>;
+
+#endif
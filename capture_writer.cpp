@@ -0,0 +1,139 @@
+#include "capture_writer.h"
+#include "log.h"
+#include <algorithm>
+#include <chrono>
+
+template<typename T>
+SpscRingT<T>::SpscRingT(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+// Indices only grow; slot = index & mask. The release store publishes the slot's contents
+// to the acquire load on the other side.
+template<typename T>
+bool SpscRingT<T>::push(const CapturedFrameT<T>& frame) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+        return false;
+    }
+    slots_[tail & mask_] = frame;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+bool SpscRingT<T>::pop(CapturedFrameT<T>& frame) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    frame = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+CaptureWriterT<T>::CaptureWriterT(const std::vector<std::string>& filenames, size_t ring_frames)
+    : ring_(ring_frames), files_(filenames.size()), frame_counts_(filenames.size(), 0) {
+    for (size_t b = 0; b < filenames.size(); b++) {
+        files_[b].open(filenames[b], std::ios::binary | std::ios::trunc);
+        if (!files_[b]) {
+            LOG_ERROR("CaptureWriter: cannot open " << filenames[b]);
+            continue;
+        }
+        size_t outerSize = 0; // patched by close()
+        files_[b].write(reinterpret_cast<const char*>(&outerSize), sizeof(outerSize));
+    }
+    writer_ = std::thread(&CaptureWriterT<T>::run, this);
+}
+
+template<typename T>
+CaptureWriterT<T>::~CaptureWriterT() {
+    close();
+}
+
+template<typename T>
+bool CaptureWriterT<T>::write(uint32_t block, const T* values, size_t count) {
+    if (closed_ || block >= files_.size() || !files_[block].is_open() || count > CAPTURED_FRAME_VALUES) {
+        if (count > CAPTURED_FRAME_VALUES) {
+            LOG_ERROR("CaptureWriter: frame of " << count << " values, slots hold " << CAPTURED_FRAME_VALUES);
+        }
+        return false;
+    }
+    while (!backlog_.empty() && ring_.push(backlog_.front())) {
+        backlog_.pop_front();
+    }
+
+    CapturedFrameT<T> frame;
+    frame.block = block;
+    frame.count = (uint32_t)count;
+    std::copy(values, values + count, frame.values);
+    if (!backlog_.empty() || !ring_.push(frame)) {
+        backlog_.push_back(frame); // behind anything already waiting, so each file stays in order
+        backlog_peak_ = std::max(backlog_peak_, backlog_.size());
+    }
+    return true;
+}
+
+template<typename T>
+void CaptureWriterT<T>::run() {
+    CapturedFrameT<T> frame;
+    while (true) {
+        bool stopping = stop_.load(std::memory_order_acquire);
+        size_t drained = 0;
+        while (ring_.pop(frame)) {
+            std::ofstream& file = files_[frame.block];
+            size_t innerSize = frame.count;
+            file.write(reinterpret_cast<const char*>(&innerSize), sizeof(innerSize));
+            file.write(reinterpret_cast<const char*>(frame.values), innerSize * sizeof(T));
+            frame_counts_[frame.block]++;
+            drained++;
+        }
+        frames_written_.fetch_add(drained, std::memory_order_relaxed);
+        if (drained == 0) {
+            if (stopping) {
+                break; // stop was set before this empty pass, so nothing more is coming
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+template<typename T>
+void CaptureWriterT<T>::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    while (!backlog_.empty()) {
+        if (ring_.push(backlog_.front())) {
+            backlog_.pop_front();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    stop_.store(true, std::memory_order_release);
+    writer_.join();
+
+    for (size_t b = 0; b < files_.size(); b++) {
+        if (!files_[b].is_open()) {
+            continue;
+        }
+        files_[b].seekp(0);
+        files_[b].write(reinterpret_cast<const char*>(&frame_counts_[b]), sizeof(size_t));
+        files_[b].close();
+        if (!files_[b]) {
+            LOG_ERROR("CaptureWriter: writing block " << b << " failed");
+        }
+    }
+}
+
+template class SpscRingT<float>;
+template class SpscRingT<double>;
+template class CaptureWriterT<float>;
+template class CaptureWriterT<double>;
@@ -0,0 +1,81 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef CAPTURE_WRITER_H
+#define CAPTURE_WRITER_H
+
+// Streams captured frames to disk off the render thread. The capture loop hands each
+// block's frame to a lock-free single-producer/single-consumer ring; a writer thread
+// drains it and appends to one file per block, so rendering never waits on disk and
+// the I/O is linear in the session length instead of rewriting the history.
+// Defined in capture_writer.cpp for float and double.
+
+// Values one ring slot holds: 16 (t,x,y,z) events, main's blocks use 9
+const size_t CAPTURED_FRAME_VALUES = 64;
+
+template<typename T>
+struct CapturedFrameT {
+    uint32_t block;
+    uint32_t count; // values used
+    T values[CAPTURED_FRAME_VALUES];
+};
+
+// Fixed-capacity ring (rounded up to a power of two). push is only called by one thread
+// and pop by one other; head and tail sit on their own cache lines.
+template<typename T>
+class SpscRingT {
+public:
+    explicit SpscRingT(size_t capacity);
+    bool push(const CapturedFrameT<T>& frame); // false if full
+    bool pop(CapturedFrameT<T>& frame);        // false if empty
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<CapturedFrameT<T>> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0}; // next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail_{0}; // next slot to push, written by the producer
+};
+
+template<typename T>
+class CaptureWriterT {
+public:
+    // filenames[b] receives block b's frames, in saveVector's format once close() has run
+    explicit CaptureWriterT(const std::vector<std::string>& filenames, size_t ring_frames = 1024);
+    ~CaptureWriterT(); // close()
+    CaptureWriterT(const CaptureWriterT&) = delete;
+    CaptureWriterT& operator=(const CaptureWriterT&) = delete;
+
+    // Render thread only. Never blocks: if the writer falls behind and the ring is full,
+    // the frame waits in a backlog that later calls hand over. False if block has no open
+    // file or count exceeds CAPTURED_FRAME_VALUES.
+    bool write(uint32_t block, const T* values, size_t count);
+    // Hands over the backlog, waits for the writer to drain and writes the frame counts
+    void close();
+
+    size_t framesWritten() const { return frames_written_.load(std::memory_order_relaxed); }
+    size_t backlogPeak() const { return backlog_peak_; } // frames that had to wait for ring space, at most at once
+
+private:
+    void run();
+
+    SpscRingT<T> ring_;
+    std::vector<std::ofstream> files_;
+    std::vector<size_t> frame_counts_; // per file, only touched by the writer thread
+    std::deque<CapturedFrameT<T>> backlog_;
+    size_t backlog_peak_ = 0;
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> frames_written_{0};
+    std::thread writer_;
+    bool closed_ = false;
+};
+
+using CaptureWriter = CaptureWriterT<float>;
+
+#endif
@@ -0,0 +1,1064 @@
+#include "event_pipeline.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include "boost_kernels.h"
+#include "worker_pool.h"
+#include "log.h"
+
+// Each group of 3 gets a 't' prepended, plus an extra 't' at the very end
+template<typename T>
+static void fill_insert_t(const float *pts, int num_groups, T t, T *new_pts) {
+    int new_index = 0;
+    for (int i = 0; i < num_groups; i++) {
+        new_pts[new_index++] = t;
+        new_pts[new_index++] = pts[i * 3];
+        new_pts[new_index++] = pts[i * 3 + 1];
+        new_pts[new_index++] = pts[i * 3 + 2];
+    }
+    new_pts[new_index] = t;
+}
+
+template<typename T>
+T *insert_t(const float *pts, int num_groups, T t) {
+    int new_size = num_groups * 4 + 1; // +1 for the extra t at the end
+
+    // Allocate memory for the new array.  Always check for allocation errors!
+    T *new_pts = (T *)malloc(new_size * sizeof(T));
+    if (new_pts == NULL) {
+        LOG_ERROR("insert_t: memory allocation failed");
+        return NULL; // Indicate failure
+    }
+    fill_insert_t(pts, num_groups, t, new_pts);
+    return new_pts;
+}
+
+template<typename T>
+T *insert_t(const float *pts, int num_groups, T t, FrameArena& arena) {
+    T *new_pts = arena.alloc<T>(num_groups * 4 + 1);
+    fill_insert_t(pts, num_groups, t, new_pts);
+    return new_pts;
+}
+
+template<typename T>
+int lookup_index(const std::vector<T>& sorted_array, typename std::vector<T>::value_type target_value) {
+    if (sorted_array.empty()) {
+        return -1; //Handle empty inputs
+    }
+
+    int index = std::upper_bound(sorted_array.begin(), sorted_array.end(), target_value) - sorted_array.begin() -1;
+
+    //Handle boundary conditions
+    if (index < 0) index = 0;
+    if (index >= (int)sorted_array.size()) index = sorted_array.size() - 1;
+
+    return index;
+}
+
+template<typename T>
+std::vector<T> lookup_row(const std::vector<T>& sorted_array, const std::vector<std::vector<T>>& data_matrix, typename std::vector<T>::value_type target_value) {
+    if (sorted_array.empty() || data_matrix.empty()) {
+        return {}; //Handle empty inputs
+    }
+
+    return data_matrix[lookup_index(sorted_array, target_value)];
+}
+
+template<typename T>
+std::vector<T> shift_array(const std::vector<T>& input) {
+    if (input.empty()) {
+        return {}; // Handle empty input
+    }
+
+    //Find the minimum element.  Handle potential NaN values.
+    T min_val = std::numeric_limits<T>::infinity();
+    for(T val : input){
+        if(val < min_val){
+            min_val = val;
+        }
+    }
+
+    T offset = 0.1f - min_val;
+    std::vector<T> shifted_array(input.size());
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        shifted_array[i] = input[i] + offset;
+    }
+
+    return shifted_array;
+}
+
+
+template<typename T>
+std::vector<T> average_start_times(const std::vector<std::vector<std::vector<T>>>& result) {
+    size_t shortest = result[0].size(); // as in process_to_vertices, so times and meshes line up
+    for (const std::vector<std::vector<T>>& group : result) {
+        shortest = std::min(shortest, group.size());
+    }
+    int num_timesteps = shortest;
+    int num_groups = result.size();
+    std::vector<T> averages(num_timesteps);
+
+    for (int t = 0; t < num_timesteps; ++t) {
+        T sum = 0;
+        for (int g = 0; g < num_groups; ++g) {
+            sum +=  result[g][t][0];
+        }
+        averages[t] = sum / num_groups;
+    }
+
+    averages = shift_array(averages);
+    return averages;
+}
+// Helper function to check if a vector is all zeros
+template<typename T>
+bool isAllZeros(const std::vector<T>& vec) {
+    return std::all_of(vec.begin(), vec.end(), [](T f){ return f == 0.0f; });
+}
+
+template<typename T>
+void removeZeroVectors(std::vector<std::vector<std::vector<T>>>& data) {
+    for (auto& middle : data) {
+        // Use erase with remove_if for efficient removal
+        middle.erase(std::remove_if(middle.begin(), middle.end(), isAllZeros<T>), middle.end());
+    }
+
+     // Optionally remove any now-empty middle vectors.  This is only needed if you
+     // want to get rid of middle vectors that became empty *after* removing
+     // the inner zero vectors.
+
+    data.erase(std::remove_if(data.begin(), data.end(), [](const std::vector<std::vector<T>>& middle){ return middle.empty(); }), data.end());
+}
+
+
+// Sorts each group's rows by t and trims every group to the time range they all cover
+template<typename T>
+static std::vector<std::vector<std::vector<T>>> sortAndTrimGroups(std::vector<std::vector<std::vector<T>>>& new_vectors, int groups)
+{
+    for (int i = 0; i < groups; ++i) {
+        sort(new_vectors[i].begin(), new_vectors[i].end(), [](const std::vector<T>& a, const std::vector<T>& b) {
+            return a[0] < b[0];
+        });
+    }
+
+    // Find the group with the smallest first entry
+    int smallest_group_index = 0;
+    T smallest_first_entry = new_vectors[0][0][0];
+
+    for (size_t i = 1; i < new_vectors.size(); ++i) {
+        if (new_vectors[i][0][0] < smallest_first_entry) {
+            smallest_first_entry = new_vectors[i][0][0];
+            smallest_group_index = i;
+        }
+    }
+
+    LOG_DEBUG("The group with the smallest first entry (" << smallest_first_entry << ") is group " << smallest_group_index + 1);
+    // Find the group with the largest first entry
+    int largest_group_index = 0;
+    T largest_first_entry = new_vectors[0][0][0];
+
+    for (size_t i = 1; i < new_vectors.size(); ++i) {
+        if (new_vectors[i][0][0] > largest_first_entry) {
+            largest_first_entry = new_vectors[i][0][0];
+            largest_group_index = i;
+        }
+    }
+
+    LOG_DEBUG("The group with the largest first entry (" << largest_first_entry << ") is group " << largest_group_index + 1);
+
+    // Find the group with the largest and smallest first entries of the last row
+    size_t lastRowIndex = new_vectors[0].size() > 0 ? new_vectors[0].size() - 1 : 0; //Handle empty case
+
+    if (new_vectors.empty() || new_vectors[0].empty()) {
+        LOG_ERROR("processEvents: new_vectors is empty");
+    }
+
+    size_t maxGroupIndex = 0;
+    T maxLastEntry = new_vectors[0][lastRowIndex][0];
+    size_t minGroupIndex = 0;
+    T minLastEntry = new_vectors[0][lastRowIndex][0];
+
+    for (size_t i = 1; i < new_vectors.size(); ++i) {
+        if (new_vectors[i][lastRowIndex][0] > maxLastEntry) {
+            maxLastEntry = new_vectors[i][lastRowIndex][0];
+            maxGroupIndex = i;
+        }
+        if (new_vectors[i][lastRowIndex][0] < minLastEntry) {
+            minLastEntry = new_vectors[i][lastRowIndex][0];
+            minGroupIndex = i;
+        }
+    }
+
+    LOG_DEBUG("The group with the largest last entry (" << maxLastEntry << ") is group " << maxGroupIndex + 1);
+    LOG_DEBUG("The group with the smallest last entry (" << minLastEntry << ") is group " << minGroupIndex + 1);
+
+    LOG_DEBUG("min(largest last, largest first) = " << std::min({maxLastEntry, largest_first_entry}));
+
+    for (auto& data : new_vectors) {
+        for (auto& row : data) { // Use a range-based for loop with a reference
+            if (!row.empty() && row[0] < largest_first_entry) {
+                row = {0.0f, 0.0f, 0.0f, 0.0f}; // Directly assign the new vector
+                //std::cout << row[0] << " " << row[1] << " " << row[2] << " " << row[3] << std::endl;
+            }
+        }
+    }
+
+    for (auto& data : new_vectors) {
+        for (auto& row : data) { // Use a range-based for loop with a reference
+            if (!row.empty() && row[0] > minLastEntry) {
+                row = {0.0f, 0.0f, 0.0f, 0.0f}; // Directly assign the new vector
+                //std::cout << row[0] << " " << row[1] << " " << row[2] << " " << row[3] << std::endl;
+            }
+        }
+    }
+
+    removeZeroVectors(new_vectors);
+
+
+    /*
+    // assume ascending, so kill the smallest in the front
+    for (int i=0; i < new_vectors.size(); ++i) {
+        for (int j=0; j < new_vectors[i].size(); ++j) {
+            if (new_vectors[i][j][0] < largest_first_entry) {
+                std::cout <<  ""  << std::endl;
+                std::cout << new_vectors[i][j][0] << std::endl;
+                //new_vectors[i][j] = {0,0,0,0};
+            }
+        }
+    }
+    for (int i = new_vectors[0].size() - 1; i >= 0; --i) {
+        for (int j = new_vectors[i][j].size() - 1; j >= 0; --j) {
+            if (new_vectors[i][j][0] > minLastEntry) {
+                std::cout << "d" << std::endl;
+                std::cout << new_vectors[i][j][0] << std::endl;
+                //new_vectors[i][j] = {0, 0, 0, 0};
+            }
+        }
+    } */
+
+
+
+    for(int i = 0; i < groups; ++i) {
+        //new_vectors[i][0][0];
+    }
+
+    /*
+    // 1. Print before sorting:
+    std::cout << "Before Sorting:" << std::endl;
+    for (int i = 0; i < groups; ++i) {
+        std::cout << "Group " << i + 1 << ":" << std::endl;
+        for (const auto& inner_vec : new_vectors[i]) {
+            for (T val : inner_vec) {
+                std::cout << val << " ";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    */
+
+
+
+    return new_vectors;
+
+}
+
+// Function to process events and return the reorganized data
+template<typename T>
+std::vector<std::vector<std::vector<T>>> processEvents(const std::vector<std::vector<T>>& events, int groups, int values_per_group)
+{
+    int events_size = events.size();
+    if (events.size() != events_size) {
+        LOG_ERROR("processEvents: inconsistent events_size and events size");
+        //Return an empty std::vector to indicate an error.  Could throw an exception for better error handling
+        return {};
+    }
+
+    std::vector<std::vector<std::vector<T>>> new_vectors(groups);
+
+    for (int i = 0; i < groups; ++i) {
+        new_vectors[i].resize(events_size);
+        for (int j = 0; j < events_size; ++j) {
+            if (events[j].size() < (i + 1) * values_per_group) {
+                LOG_ERROR("processEvents: insufficient elements in events[" << j << "]");
+                return {}; //Return an empty vector to indicate an error
+            }
+            new_vectors[i][j].resize(values_per_group);
+            for (int k = 0; k < values_per_group; ++k) {
+                new_vectors[i][j][k] = events[j][i * values_per_group + k];
+            }
+        }
+    }
+    return sortAndTrimGroups(new_vectors, groups);
+}
+
+template<typename T>
+std::vector<std::vector<std::vector<T>>> processEvents(const EventStoreT<T>& store, uint32_t block, int groups)
+{
+    if (store.frames() == 0) {
+        LOG_ERROR("processEvents: no frames");
+        return {};
+    }
+    std::vector<std::vector<std::vector<T>>> new_vectors(groups, std::vector<std::vector<T>>(store.frames()));
+    // A chunk's frames at a time: spans into a spilled store only last until another chunk is read
+    // Frames the block was elided from as static have no span: their rows are generated from
+    // the run into static_rows, groups * 4 values per frame of the batch
+    std::vector<EventSpanT<T>> spans;
+    std::vector<T> rows, static_rows;
+    for (size_t first = 0; first < store.frames();) {
+        size_t last = first;
+        spans.clear();
+        while (last < store.frames() && store.chunkOf(last) == store.chunkOf(first) &&
+               last - first < EventStoreT<T>::CHUNK_EVENTS) {
+            spans.push_back(store.frameBlock(last, block));
+            size_t count = spans.back().count;
+            if (count == 0 && (count = store.staticRows(last, block, rows)) >= (size_t)groups) {
+                static_rows.resize((last - first + 1) * groups * 4);
+                std::copy(rows.begin(), rows.begin() + groups * 4, static_rows.begin() + (last - first) * groups * 4);
+            }
+            if (count < (size_t)groups) {
+                LOG_ERROR("processEvents: block " << block << " has " << count << " events in frame " << last);
+                return {};
+            }
+            last++;
+        }
+        for (int i = 0; i < groups; ++i) {
+            for (size_t j = first; j < last; ++j) {
+                const EventSpanT<T>& span = spans[j - first];
+                if (span.count == 0) {
+                    const T* e = static_rows.data() + ((j - first) * groups + i) * 4;
+                    new_vectors[i][j] = {e[0], e[1], e[2], e[3]};
+                } else {
+                    new_vectors[i][j] = {span.t[i], span.x[i], span.y[i], span.z[i]};
+                }
+            }
+        }
+        first = last;
+    }
+    return sortAndTrimGroups(new_vectors, groups);
+}
+
+template<typename T>
+std::vector<std::vector<T>> process_to_points(const std::vector<std::vector<std::vector<T>>>& input) {
+    int num_timesteps = input[0].size(); // Assumes all groups have the same number of time steps.
+    int num_groups = input.size();
+    //std::cout << "num_timesteps: " << num_groups << std::endl;
+    int values_per_group = input[0][0].size();
+
+    std::vector<std::vector<T>> points(num_timesteps);
+
+    for (int t = 0; t < num_timesteps; ++t) {
+        for (int g = 1; g < num_groups; ++g) {
+
+            std::vector<T> neg_center_pos = {0,0,0};
+            for(int i = 1; i < 4; ++i) {
+                neg_center_pos[i-1] = -1 * input[0][t][i];
+                //std::cout << neg_center_pos[i-1] << std::endl;
+            }
+
+
+            for (int i = 1; i < values_per_group; ++i) { // indices 1,2,3
+                points[t].push_back(input[g][t][i] - neg_center_pos[i-1] );
+            }
+        }
+    }
+
+    return points;
+}
+
+
+// 6 faces, each having pt_per_face vertices with 3 components each
+static void fill_pts_to_vertices(const float pts[], int pt_per_face, float* vertices) {
+    // 1. Copy top face (pts[0] to pts[pt_per_face-1])
+    std::copy(pts, pts + pt_per_face*3, vertices);
+
+    // 2. Copy bottom face (pts[pt_per_face] to pts[2*pt_per_face-1])
+    std::copy(pts + pt_per_face*3, pts + 2 * pt_per_face *3, vertices + pt_per_face *3);
+
+
+    int front_start_i = 2*pt_per_face*3;
+    int front_order[] = {5,3,2,6};
+    for (int i = 0; i < 4; ++i) {
+        // need the 4,0,1,7 vertices here
+        int which_vertex = front_order[i];
+        int start_of_vertex = which_vertex*3;
+
+        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +front_start_i  );
+        front_start_i += 3;
+   }
+
+
+    int back_start_i = 3*pt_per_face*3;
+    int back_order[] = {4,7,1,0};
+    for (int i = 0; i < 4; ++i) {
+        // need the 4,0,1,7 vertices here
+        int which_vertex = back_order[i];
+        int start_of_vertex = which_vertex*3;
+
+        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +back_start_i  );
+        back_start_i += 3;
+   }
+
+    int right_start_i = 4*pt_per_face*3;
+    int right_order[] = {7,6,2,1};
+    for (int i = 0; i < 4; ++i) {
+        // need the 4,0,1,7 vertices here
+        int which_vertex = right_order[i];
+        int start_of_vertex = which_vertex*3;
+
+        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +right_start_i  );
+        right_start_i += 3;
+   }
+
+    int left_start_i = 5*pt_per_face*3;
+    int left_order[] = {4,0,3,5};
+    for (int i = 0; i < 4; ++i) {
+        // need the 4,0,1,7 vertices here
+        int which_vertex = left_order[i];
+        int start_of_vertex = which_vertex*3;
+
+        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +left_start_i  );
+        left_start_i += 3;
+   } /*
+
+
+    /*
+    const char* faces[] = {"Top", "Bottom", "Front", "Back", "Right", "Left"};
+    for (int i = 0; i < 6; ++i) {
+        std::cout << faces[i] << " face vertices: ";
+        for (int j = 0; j < pt_per_face*3; j+=3) {
+            std::cout << "(" << vertices[i * pt_per_face*3 + j] << ", " << vertices[i * pt_per_face*3 + j + 1] << ", " << vertices[i * pt_per_face*3 + j + 2] << ") ";
+        }
+        std::cout << std::endl;
+    }
+    */
+}
+
+float* pts_to_vertices(float pts[], int pt_per_face) {
+    float* vertices = new float[6 * 3 * pt_per_face];  // 6 faces, each having pt_per_face vertices with 3 components each
+    fill_pts_to_vertices(pts, pt_per_face, vertices);
+    return vertices;
+}
+
+float* pts_to_vertices(const float pts[], int pt_per_face, FrameArena& arena) {
+    float* vertices = arena.alloc<float>(6 * 3 * pt_per_face);
+    fill_pts_to_vertices(pts, pt_per_face, vertices);
+    return vertices;
+}
+
+static void fill_cube_vertices(float width, float height, float length, float* vertices) {
+    float a = width; float b = height; float c = length;
+    const float corner_vertices[] = {
+        // top face
+        -a/2, -b/2, c/2,
+        a/2, -b/2, c/2,
+        a/2, b/2, c/2,
+        -a/2, b/2, c/2,
+        // bottom face
+        -a/2, -b/2, -c/2,
+        -a/2, b/2, -c/2,
+        a/2, b/2, -c/2,
+        a/2, -b/2, -c/2,
+    };
+    std::copy(corner_vertices, corner_vertices + 24, vertices);
+}
+
+// pt_per_face should be 4, as of now
+std::vector<float> cube_vertices(float width, float height, float length, int pt_per_face) {
+    std::vector<float> vertices(24);
+    fill_cube_vertices(width, height, length, vertices.data());
+    return vertices;
+}
+
+float* cube_vertices(float width, float height, float length, int pt_per_face, FrameArena& arena) {
+    float* vertices = arena.alloc<float>(24);
+    fill_cube_vertices(width, height, length, vertices);
+    return vertices;
+}
+
+float* prepend_center(const float* corners, int corner_count, const float* center, FrameArena& arena) {
+    float* groups = arena.alloc<float>((corner_count + 1) * 3);
+    std::copy(center, center + 3, groups);
+    for (int i = 0; i < corner_count; i++) {
+        for (int j = 0; j < 3; j++) {
+            groups[(i + 1) * 3 + j] = corners[i * 3 + j] + center[j];
+        }
+    }
+    return groups;
+}
+
+// Corner order of the 6 faces x 4 vertices, the same order pts_to_vertices produces
+static const int CUBE_FACE_CORNERS[24] = {
+    0, 1, 2, 3,  // top
+    4, 5, 6, 7,  // bottom
+    5, 3, 2, 6,  // front
+    4, 7, 1, 0,  // back
+    7, 6, 2, 1,  // right
+    4, 0, 3, 5   // left
+};
+
+// process_to_points + get_lorentz_center_pos + pts_to_vertices in one sweep per timestep,
+// written straight into two flat buffers sized once up front
+template<typename T>
+bool process_to_vertices(const std::vector<std::vector<std::vector<T>>>& input, std::vector<float>& vertices, std::vector<float>& centers) {
+    if (input.size() != 9 || input[0].empty()) {
+        LOG_ERROR("process_to_vertices: needs a center and 8 corner groups");
+        return false;
+    }
+    // Trimming can leave groups a row or two apart; only timesteps every group has are drawn
+    size_t num_timesteps = input[0].size();
+    for (const std::vector<std::vector<T>>& group : input) {
+        num_timesteps = std::min(num_timesteps, group.size());
+    }
+    vertices.resize(num_timesteps * CUBE_MESH_FLOATS);
+    centers.resize(num_timesteps * 3);
+
+    for (size_t t = 0; t < num_timesteps; ++t) {
+        const T* center = &input[0][t][1];
+        float* center_out = &centers[t * 3];
+        float* vertex_out = &vertices[t * CUBE_MESH_FLOATS];
+        for (int i = 0; i < 3; ++i) {
+            center_out[i] = center[i];
+        }
+        for (int v = 0; v < 24; ++v) {
+            const T* corner = &input[1 + CUBE_FACE_CORNERS[v]][t][1];
+            for (int i = 0; i < 3; ++i) {
+                vertex_out[v * 3 + i] = corner[i] + center[i];
+            }
+        }
+    }
+    return true;
+}
+
+// One frame's events of a block as a span: the stored one or, if the block was elided as
+// static there, its run's rows laid out as columns in static_columns
+template<typename T>
+static bool blockSpan(const EventStoreT<T>& store, size_t frame, uint32_t block, std::vector<T>& rows,
+                      std::vector<T>& static_columns, EventSpanT<T>& span) {
+    span = store.frameBlock(frame, block);
+    size_t count = span.count;
+    if (count == 0 && (count = store.staticRows(frame, block, rows)) > 0) {
+        static_columns.resize(count * 4);
+        for (size_t i = 0; i < count * 4; i++) {
+            static_columns[(i % 4) * count + i / 4] = rows[i];
+        }
+        const T* c = static_columns.data();
+        span = {c, c + count, c + count * 2, c + count * 3, nullptr, nullptr, count};
+    }
+    if (count < 9) {
+        LOG_ERROR("processVertices: block " << block << " has " << count << " events in frame " << frame);
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool processVertices(const EventStoreT<T>& store, uint32_t block, std::vector<float>& vertices, std::vector<float>& centers, std::vector<T>& times) {
+    const int GROUPS = 9; // center, then the 8 corners
+    const size_t frames = store.frames();
+    if (frames == 0 || frames > UINT32_MAX) {
+        LOG_ERROR("processVertices: " << frames << " frames");
+        return false;
+    }
+
+    // Pass 1: every group's t, whether its row is all zero (processEvents drops those after
+    // trimming), and the center positions corners are drawn around
+    std::vector<T> keys(frames * GROUPS), center_xyz(frames * 3);
+    std::vector<uint8_t> zero_row(frames * GROUPS);
+    std::vector<T> rows, static_columns;
+    EventSpanT<T> span;
+    for (size_t f = 0; f < frames; f++) {
+        if (!blockSpan(store, f, block, rows, static_columns, span)) {
+            return false;
+        }
+        for (int g = 0; g < GROUPS; g++) {
+            T t = span.t[g], x = span.x[g], y = span.y[g], z = span.z[g];
+            keys[g * frames + f] = t;
+            zero_row[g * frames + f] = t == 0 && x == 0 && y == 0 && z == 0;
+            if (g == 0) {
+                center_xyz[f * 3] = x;
+                center_xyz[f * 3 + 1] = y;
+                center_xyz[f * 3 + 2] = z;
+            }
+        }
+    }
+
+    // Each group's frames in t order, ties by frame, then trimmed as sortAndTrimGroups does:
+    // to [largest first t, smallest last t] over the groups, less the all-zero rows
+    std::vector<uint32_t> order(frames * GROUPS), rank(frames * GROUPS, UINT32_MAX);
+    T largest_first = 0, smallest_last = 0;
+    for (int g = 0; g < GROUPS; g++) {
+        uint32_t* group = &order[g * frames];
+        const T* group_keys = &keys[g * frames];
+        for (size_t f = 0; f < frames; f++) {
+            group[f] = (uint32_t)f;
+        }
+        std::sort(group, group + frames, [group_keys](uint32_t a, uint32_t b) {
+            return group_keys[a] < group_keys[b] || (group_keys[a] == group_keys[b] && a < b);
+        });
+        T first = group_keys[group[0]], last = group_keys[group[frames - 1]];
+        largest_first = g == 0 ? first : std::max(largest_first, first);
+        smallest_last = g == 0 ? last : std::min(smallest_last, last);
+    }
+    size_t timesteps = frames;
+    for (int g = 0; g < GROUPS; g++) {
+        uint32_t* group = &order[g * frames];
+        size_t kept = 0;
+        for (size_t i = 0; i < frames; i++) {
+            uint32_t f = group[i];
+            T t = keys[g * frames + f];
+            if (t >= largest_first && t <= smallest_last && !zero_row[g * frames + f]) {
+                rank[g * frames + f] = (uint32_t)kept;
+                group[kept++] = f;
+            }
+        }
+        timesteps = std::min(timesteps, kept);
+    }
+    if (timesteps == 0) {
+        LOG_ERROR("processVertices: block " << block << " has no time range common to all its events");
+        return false;
+    }
+
+    centers.resize(timesteps * 3);
+    times.resize(timesteps);
+    for (size_t s = 0; s < timesteps; s++) {
+        const T* center = &center_xyz[order[s] * 3];
+        for (int i = 0; i < 3; i++) {
+            centers[s * 3 + i] = center[i];
+        }
+        T sum = 0;
+        for (int g = 0; g < GROUPS; g++) {
+            sum += keys[g * frames + order[g * frames + s]];
+        }
+        times[s] = sum / GROUPS;
+    }
+    times = shift_array(times);
+
+    // Pass 2: each corner event goes straight to the three face vertices it appears as,
+    // placed around the center of the same timestep
+    int corner_vertices[8][3], found[8] = {};
+    for (int v = 0; v < 24; v++) {
+        int c = CUBE_FACE_CORNERS[v];
+        corner_vertices[c][found[c]++] = v;
+    }
+    vertices.resize(timesteps * CUBE_MESH_FLOATS);
+    for (size_t f = 0; f < frames; f++) {
+        if (!blockSpan(store, f, block, rows, static_columns, span)) {
+            return false;
+        }
+        for (int g = 1; g < GROUPS; g++) {
+            uint32_t s = rank[g * frames + f];
+            if (s >= timesteps) {
+                continue;
+            }
+            const T* center = &center_xyz[order[s] * 3];
+            T corner[3] = {span.x[g], span.y[g], span.z[g]};
+            for (int v : corner_vertices[g - 1]) {
+                float* out = &vertices[s * CUBE_MESH_FLOATS + v * 3];
+                for (int i = 0; i < 3; i++) {
+                    out[i] = corner[i] + center[i];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template<typename T>
+std::vector<std::vector<T>> get_lorentz_center_pos(const std::vector<std::vector<std::vector<T>>>& input) {
+    int num_timesteps = input[0].size(); // Assumes all groups have the same number of time steps.
+    int num_groups = input.size();
+    //std::cout << "num_timesteps: " << num_groups << std::endl;
+    int values_per_group = input[0][0].size();
+
+    std::vector<std::vector<T>> points(num_timesteps);
+
+    for (int t = 0; t < num_timesteps; ++t) {
+        for (int g = 0; g < 1; ++g) {
+
+            std::vector<T> neg_center_pos = {0,0,0};
+            for(int i = 1; i < 4; ++i) {
+                neg_center_pos[i-1] = -1 * input[0][t][i];
+                //std::cout << neg_center_pos[i-1] << std::endl;
+            }
+
+
+            for (int i = 1; i < values_per_group; ++i) { // indices 1,2,3
+                points[t].push_back(input[0][t][i]);
+            }
+        }
+    }
+
+    return points;
+}
+
+
+template<typename T>
+void saveVector(const std::vector<std::vector<T>>& vec, const std::string& filename) {
+    std::ofstream outFile(filename, std::ios::binary | std::ios::trunc);
+    size_t outerSize = vec.size();
+    outFile.write(reinterpret_cast<const char*>(&outerSize), sizeof(outerSize));
+    for (const auto& innerVec : vec) {
+        size_t innerSize = innerVec.size();
+        outFile.write(reinterpret_cast<const char*>(&innerSize), sizeof(innerSize));
+        outFile.write(reinterpret_cast<const char*>(innerVec.data()), innerSize * sizeof(T));
+    }
+}
+
+template<typename T>
+std::vector<std::vector<T>> loadVector(const std::string& filename) {
+    std::ifstream inFile(filename, std::ios::binary | std::ios::ate);
+    std::streamsize fileSize = inFile.tellg();
+    inFile.seekg(0, std::ios::beg);
+
+    size_t outerSize;
+    inFile.read(reinterpret_cast<char*>(&outerSize), sizeof(outerSize));
+
+    std::vector<std::vector<T>> vec(outerSize);
+
+    for (size_t i = 0; i < outerSize; ++i) {
+        size_t innerSize;
+        inFile.read(reinterpret_cast<char*>(&innerSize), sizeof(innerSize));
+
+        if (inFile.tellg() + static_cast<std::streamoff>(innerSize * sizeof(T)) > fileSize) {
+            LOG_ERROR("loadVector: read beyond file size of " << filename);
+            return {};
+        }
+
+        vec[i].resize(innerSize);
+        inFile.read(reinterpret_cast<char*>(vec[i].data()), innerSize * sizeof(T));
+    }
+        vec.erase(
+        std::remove_if(vec.begin(), vec.end(), [](const std::vector<T>& row) {
+            return row.empty();
+        }),
+        vec.end()
+    );
+
+    return vec;
+}
+
+
+// Below this many events a part costs less to boost (~4 ns an event through 9-event frames,
+// ~16 us here) than the few pool wake-ups and the lock it takes to hand it out
+static const size_t MIN_EVENTS_PER_PART = 4096;
+
+template<typename T>
+BoostStatus transformFrames(const std::vector<std::vector<std::vector<T>>*>& datasets, const T* velocity, int values_per_frame, unsigned thread_count) {
+    // One matrix for every frame, built here because the cache is per thread
+    Mat4T<T> boost;
+    BoostStatus status = transformationCache<T>().get(velocity, boost);
+    if (status != BOOST_OK) {
+        LOG_ERROR("transformFrames: " << boostStatusMessage(status));
+        return status;
+    }
+    transformFrames(datasets, boost, values_per_frame, thread_count);
+    return BOOST_OK;
+}
+
+template<typename T>
+void transformFrames(const std::vector<std::vector<std::vector<T>>*>& datasets, const Mat4T<T>& boost, int values_per_frame, unsigned thread_count) {
+    int axis = boostAxis(boost); // checked once here rather than per frame
+    size_t frames = 0;
+    for (const std::vector<std::vector<T>>* dataset : datasets) {
+        frames += dataset->size();
+    }
+
+    // Parts are equal runs of frames across the datasets back to back, sized in events
+    // (values_per_frame / 4 per frame), so the part count follows the work, not the frame count
+    WorkerPool& pool = WorkerPool::instance();
+    size_t events = frames * std::max(values_per_frame / 4, 1);
+    size_t parts = std::min<size_t>(thread_count == 0 ? pool.threads() : thread_count,
+                                    std::max<size_t>(1, events / MIN_EVENTS_PER_PART));
+    size_t per_part = (frames + parts - 1) / std::max<size_t>(parts, 1);
+
+    // Each frame is boosted in place by exactly one part, so the result does not depend on scheduling
+    pool.run(parts, [&](size_t part) {
+        size_t begin = part * per_part, end = std::min(begin + per_part, frames);
+        size_t first = 0; // global index of the current dataset's first frame
+        for (std::vector<std::vector<T>>* dataset : datasets) {
+            size_t from = std::max(begin, first), to = std::min(end, first + dataset->size());
+            for (size_t i = from; i < to; i++) {
+                std::vector<T>& frame = (*dataset)[i - first];
+                size_t count = std::min(frame.size(), (size_t)values_per_frame) / 4;
+                boostEventsAxis(axis, boost, frame.data(), frame.data(), count);
+            }
+            first += dataset->size();
+        }
+    });
+}
+
+template<typename T>
+std::vector<std::vector<std::vector<T>>> transformObservers(const std::vector<std::vector<T>>& frames, const T* velocities, int observer_count, int values_per_frame) {
+    std::vector<Mat4T<T>> boosts(observer_count);
+    for (int k = 0; k < observer_count; k++) {
+        BoostStatus status = getBoostMat4(velocities + k * 3, boosts[k]);
+        if (status != BOOST_OK) {
+            LOG_ERROR("transformObservers: observer " << k << ", " << boostStatusMessage(status));
+            return {};
+        }
+    }
+
+    // Frames are packed back to back into tiles of MULTI_TILE_EVENTS events, so each
+    // boostEventsMulti call runs its blocked kernel over a whole tile, not one 9-event frame
+    const size_t MULTI_TILE_EVENTS = 1024;
+    size_t frame_values = (size_t)std::max(values_per_frame, 0) / 4 * 4;
+    std::vector<T> tile;
+    tile.reserve(MULTI_TILE_EVENTS * 4 + frame_values);
+    std::vector<std::vector<T>> tile_outs(observer_count, std::vector<T>(MULTI_TILE_EVENTS * 4 + frame_values));
+    std::vector<T*> outs(observer_count);
+    for (int k = 0; k < observer_count; k++) {
+        outs[k] = tile_outs[k].data();
+    }
+
+    std::vector<std::vector<std::vector<T>>> datasets(observer_count, std::vector<std::vector<T>>(frames.size()));
+    for (size_t first = 0, f = 0; first < frames.size(); first = f) {
+        tile.clear();
+        for (; f < frames.size() && tile.size() < MULTI_TILE_EVENTS * 4; f++) {
+            size_t boosted = std::min(frames[f].size() / 4 * 4, frame_values);
+            tile.insert(tile.end(), frames[f].begin(), frames[f].begin() + boosted);
+        }
+        boostEventsMulti(boosts.data(), observer_count, tile.data(), outs.data(), tile.size() / 4);
+
+        for (int k = 0; k < observer_count; k++) {
+            const T* boosted_values = outs[k];
+            for (size_t g = first; g < f; g++) {
+                const std::vector<T>& frame = frames[g];
+                size_t boosted = std::min(frame.size() / 4 * 4, frame_values);
+                std::vector<T>& out = datasets[k][g];
+                out = frame; // keeps the untouched trailing values
+                std::copy(boosted_values, boosted_values + boosted, out.begin());
+                boosted_values += boosted;
+            }
+        }
+    }
+    return datasets;
+}
+
+template<typename T>
+BoostStatus makeRigidBlock(const T* observer_velocity, const T* block_velocity, const T* body_offsets, int corner_count, RigidBlockT<T>& out) {
+    BoostStatus status = transformationCache<T>().get(observer_velocity, out.boost);
+    if (status != BOOST_OK) {
+        return status;
+    }
+    T beta_squared = block_velocity[0] * block_velocity[0] + block_velocity[1] * block_velocity[1] + block_velocity[2] * block_velocity[2];
+    if (!(beta_squared < 1)) {
+        return std::isfinite(beta_squared) ? BOOST_SPEED_NOT_BELOW_C : BOOST_NOT_FINITE;
+    }
+
+    // Copied first: the inputs may be out's own lab_velocity and body, to re-observe a block
+    T lab_velocity[3] = {block_velocity[0], block_velocity[1], block_velocity[2]};
+    std::vector<T> body(body_offsets, body_offsets + corner_count * 3);
+    std::copy(lab_velocity, lab_velocity + 3, out.lab_velocity);
+    out.body = std::move(body);
+
+    // Observed velocity from the boosted 4-velocity direction (1, v)
+    T u[4];
+    for (int r = 0; r < 4; r++) {
+        const T* row = out.boost.m[r];
+        u[r] = row[0] + row[1] * lab_velocity[0] + row[2] * lab_velocity[1] + row[3] * lab_velocity[2];
+    }
+    for (int i = 0; i < 3; i++) {
+        out.velocity[i] = u[i + 1] / u[0];
+    }
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            out.shape.m[i][j] = out.boost.m[i + 1][j + 1] - out.velocity[i] * out.boost.m[0][j + 1];
+        }
+    }
+    out.offsets.resize(corner_count * 3);
+    for (int k = 0; k < corner_count; k++) {
+        const T* d = &out.body[k * 3];
+        for (int i = 0; i < 3; i++) {
+            out.offsets[k * 3 + i] = out.shape.m[i][0] * d[0] + out.shape.m[i][1] * d[1] + out.shape.m[i][2] * d[2];
+        }
+    }
+    return BOOST_OK;
+}
+
+template<typename T>
+bool fitRigidBlock(const std::vector<std::vector<T>>& frames, const T* observer_velocity, T tolerance, RigidBlockT<T>& out, int values_per_frame) {
+    int corner_count = values_per_frame / 4 - 1;
+    if (frames.empty() || corner_count < 1) {
+        return false;
+    }
+    const std::vector<T>& first = frames.front();
+    const std::vector<T>& last = frames.back();
+    if ((int)first.size() < values_per_frame || (int)last.size() < 4) {
+        return false;
+    }
+
+    T velocity[3] = {0, 0, 0};
+    T duration = last[0] - first[0];
+    if (duration > 0) {
+        for (int i = 0; i < 3; i++) {
+            velocity[i] = (last[i + 1] - first[i + 1]) / duration;
+        }
+    }
+    // Every frame should be first + (elapsed, velocity * elapsed) value for value
+    std::vector<T> motion(values_per_frame);
+    std::vector<T> body(corner_count * 3);
+    for (int j = 0; j < values_per_frame; j++) {
+        motion[j] = j % 4 == 0 ? 1 : velocity[j % 4 - 1];
+    }
+    for (int k = 0; k < corner_count; k++) {
+        for (int i = 0; i < 3; i++) {
+            body[k * 3 + i] = first[4 + k * 4 + 1 + i] - first[1 + i];
+        }
+    }
+
+    // Largest distance of any value from the model. Kept as two running maxes per (t,x,y,z)
+    // lane in fixed-size groups, which -O2 turns into packed compares. NaN counts as infinite.
+    const T largest = std::numeric_limits<T>::max();
+    const T infinite = std::numeric_limits<T>::infinity();
+    T lanes[8] = {};
+    for (const std::vector<T>& frame : frames) {
+        if ((int)frame.size() < values_per_frame) {
+            return false;
+        }
+        T elapsed = frame[0] - first[0];
+        for (int j = 0; j < values_per_frame; j += 4) {
+            T* lane = lanes + (j & 4);
+            for (int i = 0; i < 4; i++) {
+                T error = std::fabs(frame[j + i] - (first[j + i] + motion[j + i] * elapsed));
+                error = error <= largest ? error : infinite;
+                lane[i] = error <= lane[i] ? lane[i] : error;
+            }
+        }
+    }
+    T deviation = 0;
+    for (T error : lanes) {
+        deviation = error <= deviation ? deviation : error;
+    }
+    if (!(deviation <= tolerance)) {
+        LOG_DEBUG("fitRigidBlock: events stray " << deviation << " from a rigid block");
+        return false;
+    }
+    return makeRigidBlock(observer_velocity, velocity, body.data(), corner_count, out) == BOOST_OK;
+}
+
+template<typename T>
+void boostRigidCenters(const RigidBlockT<T>& block, const std::vector<std::vector<T>>& frames, std::vector<T>& centers) {
+    centers.resize(frames.size() * 4);
+    for (size_t f = 0; f < frames.size(); f++) {
+        std::copy(frames[f].begin(), frames[f].begin() + 4, centers.begin() + f * 4);
+    }
+    boostEvents(block.boost, centers.data(), centers.data(), frames.size());
+}
+
+template<typename T>
+void rigidCorners(const RigidBlockT<T>& block, const T* center, T* corners) {
+    size_t corner_count = block.offsets.size() / 3;
+    for (size_t k = 0; k < corner_count; k++) {
+        for (int i = 0; i < 3; i++) {
+            corners[k * 3 + i] = center[i] + block.offsets[k * 3 + i];
+        }
+    }
+}
+
+CompactHistory::CompactHistory(HalfFormat format, int values_per_frame)
+    : format_(format), values_per_frame_(std::max(values_per_frame / 4 * 4, 4)) {
+}
+
+template<typename T>
+void CompactHistory::append(const T* frame) {
+    float origin[4];
+    for (int k = 0; k < 4; k++) {
+        origin[k] = (float)frame[k];
+        origins_.push_back(origin[k]);
+    }
+    for (int i = 4; i < values_per_frame_; i++) {
+        float offset = (float)frame[i] - origin[i % 4];
+        uint16_t value = floatToHalf(offset, format_);
+        values_.push_back(value);
+        double error = std::fabs((double)(origin[i % 4] + halfToFloat(value, format_)) - (double)frame[i]);
+        if (!(error <= max_error_)) max_error_ = error; // keeps NaN
+    }
+}
+
+template<typename T>
+void CompactHistory::decode(std::vector<std::vector<T>>& out) const {
+    if (out.size() < frames()) {
+        out.resize(frames());
+    }
+    for (size_t f = 0; f < frames(); f++) {
+        const float* origin = &origins_[f * 4];
+        const uint16_t* values = &values_[f * (values_per_frame_ - 4)];
+        out[f].resize(values_per_frame_);
+        std::copy(origin, origin + 4, out[f].begin());
+        for (int i = 4; i < values_per_frame_; i++) {
+            out[f][i] = origin[i % 4] + halfToFloat(values[i - 4], format_);
+        }
+    }
+}
+
+BoostStatus CompactHistory::transform(const float* velocity, std::vector<std::vector<float>>& out) const {
+    Mat4 boost;
+    BoostStatus status = transformationCache<float>().get(velocity, boost);
+    if (status != BOOST_OK) {
+        LOG_ERROR("CompactHistory::transform: " << boostStatusMessage(status));
+        return status;
+    }
+    out.resize(frames());
+    for (size_t f = 0; f < frames(); f++) {
+        out[f].resize(values_per_frame_);
+        boostEvents(boost, &origins_[f * 4], out[f].data(), 1);
+        boostHalfEvents(boost, &values_[f * (values_per_frame_ - 4)], format_, &origins_[f * 4], out[f].data() + 4, values_per_frame_ / 4 - 1);
+    }
+    return BOOST_OK;
+}
+
+void CompactHistory::reserve(size_t frame_count) {
+    origins_.reserve(frame_count * 4);
+    values_.reserve(frame_count * (values_per_frame_ - 4));
+}
+
+void CompactHistory::clear() {
+    origins_.clear();
+    values_.clear();
+    max_error_ = 0;
+}
+
+size_t CompactHistory::bytes() const {
+    return origins_.capacity() * sizeof(float) + values_.capacity() * sizeof(uint16_t);
+}
+
+size_t CompactHistory::floatBytes() const {
+    return frames() * (sizeof(std::vector<float>) + values_per_frame_ * sizeof(float));
+}
+
+// Explicit instantiations: float is the default pipeline, double is for long or high-gamma sessions
+#define INSTANTIATE_EVENT_PIPELINE(T) \
+    template T* insert_t<T>(const float*, int, T); \
+    template T* insert_t<T>(const float*, int, T, FrameArena&); \
+    template int lookup_index<T>(const std::vector<T>&, T); \
+    template std::vector<T> lookup_row<T>(const std::vector<T>&, const std::vector<std::vector<T>>&, T); \
+    template std::vector<T> shift_array<T>(const std::vector<T>&); \
+    template std::vector<T> average_start_times<T>(const std::vector<std::vector<std::vector<T>>>&); \
+    template bool isAllZeros<T>(const std::vector<T>&); \
+    template void removeZeroVectors<T>(std::vector<std::vector<std::vector<T>>>&); \
+    template std::vector<std::vector<std::vector<T>>> processEvents<T>(const std::vector<std::vector<T>>&, int, int); \
+    template std::vector<std::vector<std::vector<T>>> processEvents<T>(const EventStoreT<T>&, uint32_t, int); \
+    template std::vector<std::vector<T>> process_to_points<T>(const std::vector<std::vector<std::vector<T>>>&); \
+    template bool process_to_vertices<T>(const std::vector<std::vector<std::vector<T>>>&, std::vector<float>&, std::vector<float>&); \
+    template bool processVertices<T>(const EventStoreT<T>&, uint32_t, std::vector<float>&, std::vector<float>&, std::vector<T>&); \
+    template std::vector<std::vector<T>> get_lorentz_center_pos<T>(const std::vector<std::vector<std::vector<T>>>&); \
+    template void saveVector<T>(const std::vector<std::vector<T>>&, const std::string&); \
+    template std::vector<std::vector<T>> loadVector<T>(const std::string&); \
+    template BoostStatus transformFrames<T>(const std::vector<std::vector<std::vector<T>>*>&, const T*, int, unsigned); \
+    template void transformFrames<T>(const std::vector<std::vector<std::vector<T>>*>&, const Mat4T<T>&, int, unsigned); \
+    template std::vector<std::vector<std::vector<T>>> transformObservers<T>(const std::vector<std::vector<T>>&, const T*, int, int); \
+    template BoostStatus makeRigidBlock<T>(const T*, const T*, const T*, int, RigidBlockT<T>&); \
+    template bool fitRigidBlock<T>(const std::vector<std::vector<T>>&, const T*, T, RigidBlockT<T>&, int); \
+    template void boostRigidCenters<T>(const RigidBlockT<T>&, const std::vector<std::vector<T>>&, std::vector<T>&); \
+    template void rigidCorners<T>(const RigidBlockT<T>&, const T*, T*); \
+    template void CompactHistory::append<T>(const T*); \
+    template void CompactHistory::decode<T>(std::vector<std::vector<T>>&) const;
+
+INSTANTIATE_EVENT_PIPELINE(float)
+INSTANTIATE_EVENT_PIPELINE(double)
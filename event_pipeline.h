@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "matrix_operations.h"
+#include "boost_kernels.h"
+#include "event_store.h"
+#include "frame_arena.h"
+
+#ifndef EVENT_PIPELINE_H
+#define EVENT_PIPELINE_H
+
+// Capture -> transform -> replay helpers shared by the raylib programs.
+// T is the event scalar: float by default, double for long or high-gamma
+// sessions where GetTime() and large gamma eat float precision.
+// Everything is defined in event_pipeline.cpp for float and double.
+
+// Prepends t to every (x,y,z) group, plus one trailing t. The result is malloc'd.
+template<typename T> T* insert_t(const float* pts, int num_groups, T t);
+// Same, allocated from arena: valid until its next reset()
+template<typename T> T* insert_t(const float* pts, int num_groups, T t, FrameArena& arena);
+
+// Index of the last sorted_array entry <= target_value, clamped to the array; -1 if it is empty
+template<typename T> int lookup_index(const std::vector<T>& sorted_array, typename std::vector<T>::value_type target_value);
+
+// Row of data_matrix whose sorted_array entry is the last one <= target_value
+template<typename T>
+std::vector<T> lookup_row(const std::vector<T>& sorted_array, const std::vector<std::vector<T>>& data_matrix, typename std::vector<T>::value_type target_value);
+
+template<typename T> std::vector<T> shift_array(const std::vector<T>& input);
+template<typename T> std::vector<T> average_start_times(const std::vector<std::vector<std::vector<T>>>& result);
+template<typename T> bool isAllZeros(const std::vector<T>& vec);
+template<typename T> void removeZeroVectors(std::vector<std::vector<std::vector<T>>>& data);
+
+// Splits each frame into per-group (t,x,y,z) rows, sorts by t and trims to the common time range
+template<typename T>
+std::vector<std::vector<std::vector<T>>> processEvents(const std::vector<std::vector<T>>& events, int groups = 9, int values_per_group = 4);
+// Same, read straight from one block of an EventStore: group i is the block's i-th event in each frame
+template<typename T>
+std::vector<std::vector<std::vector<T>>> processEvents(const EventStoreT<T>& store, uint32_t block, int groups = 9);
+
+template<typename T> std::vector<std::vector<T>> process_to_points(const std::vector<std::vector<std::vector<T>>>& input);
+
+// Expands 8 corners into 6 faces of pt_per_face vertices for GenMeshShape. Allocated with new[].
+float* pts_to_vertices(float pts[], int pt_per_face);
+float* pts_to_vertices(const float pts[], int pt_per_face, FrameArena& arena);
+
+// The 8 corners of a width x height x length box centered on the origin, in the order
+// pts_to_vertices takes
+std::vector<float> cube_vertices(float width, float height, float length, int pt_per_face);
+float* cube_vertices(float width, float height, float length, int pt_per_face, FrameArena& arena);
+// center, then the corners moved to it: the 1 + corner_count (x,y,z) groups insert_t takes
+float* prepend_center(const float* corners, int corner_count, const float* center, FrameArena& arena);
+
+// Floats per block mesh: 6 faces x 4 vertices x (x,y,z), what GenMeshShape takes
+const int CUBE_MESH_FLOATS = 72;
+
+// Replay meshes for every timestep in one pass. Timestep t's mesh vertices (the same
+// values pts_to_vertices(process_to_points(input)[t]) gives) start at
+// vertices[t * CUBE_MESH_FLOATS] and its center at centers[t * 3], so the render loop
+// indexes with lookup_index instead of copying rows.
+template<typename T> bool process_to_vertices(const std::vector<std::vector<std::vector<T>>>& input, std::vector<float>& vertices, std::vector<float>& centers);
+// The same vertices and centers, and average_start_times' times, read straight from one block
+// of an EventStore with no processEvents rows in between: each group's t values are gathered
+// into one flat array, an index per group is sorted and trimmed by them, and a second pass
+// over the store writes every corner event to its mesh vertices. Static runs are expanded
+// as they are read. False, with nothing usable in the outputs, where processEvents would
+// have returned empty or process_to_vertices false.
+template<typename T> bool processVertices(const EventStoreT<T>& store, uint32_t block, std::vector<float>& vertices, std::vector<float>& centers, std::vector<T>& times);
+template<typename T> std::vector<std::vector<T>> get_lorentz_center_pos(const std::vector<std::vector<std::vector<T>>>& input);
+
+template<typename T> void saveVector(const std::vector<std::vector<T>>& vec, const std::string& filename);
+template<typename T> std::vector<std::vector<T>> loadVector(const std::string& filename);
+
+// Boosts the first values_per_frame values of every frame of every dataset in place,
+// split over at most thread_count cores of the WorkerPool (0 = all of them), and not at
+// all below a few thousand events. Same output as calling
+// transformation() on each frame, in the same order.
+template<typename T>
+BoostStatus transformFrames(const std::vector<std::vector<std::vector<T>>*>& datasets, const T* velocity, int values_per_frame = 36, unsigned thread_count = 0);
+// Same with the boost already built, e.g. a constexpr boostMat4 for a fixed scenario velocity
+template<typename T>
+void transformFrames(const std::vector<std::vector<std::vector<T>>*>& datasets, const Mat4T<T>& boost, int values_per_frame = 36, unsigned thread_count = 0);
+
+// One recording seen by observer_count observers (velocities holds 3 values each).
+// The history is read once for all of them; dataset k is what transformation() with
+// observer k's velocity would give, ready for processEvents.
+template<typename T>
+std::vector<std::vector<std::vector<T>>> transformObservers(const std::vector<std::vector<T>>& frames, const T* velocities, int observer_count, int values_per_frame = 36);
+
+// Rigid-body fast path for blocks that keep their shape and move at constant velocity.
+// Only the center worldline is boosted. Corner k sits at a fixed lab offset d_k from the
+// center at equal lab time; boosting gives (dt', dx') = boost * (0, d_k), and sliding that
+// along the block's observed velocity u' to the center's observer time leaves dx' - u' dt'.
+// That is a fixed 3x3 map of d_k (the contraction plus the shear from relative
+// simultaneity), so corners cost one add each however many vertices the block has.
+template<typename T>
+struct RigidBlockT {
+    Mat4T<T> boost;         // lab -> observer
+    T lab_velocity[3];      // block velocity in the lab
+    std::vector<T> body;    // lab offset d_k of each corner from the center, 3 values per corner
+    T velocity[3];          // block velocity seen by the observer
+    Mat3T<T> shape;         // lab offset -> offset from the center at the same observer time
+    std::vector<T> offsets; // shape * d_k, 3 values per corner
+};
+
+using RigidBlock = RigidBlockT<float>;
+
+// block_velocity is the block's lab velocity, body_offsets the corners' lab offsets from the
+// center (for main's blocks, at rest in the lab, these are the body-frame offsets)
+template<typename T>
+BoostStatus makeRigidBlock(const T* observer_velocity, const T* block_velocity, const T* body_offsets, int corner_count, RigidBlockT<T>& out);
+// Fits a block to captured frames (center event, then one event per corner, all at the
+// frame's t): offsets from the first frame, velocity from the first and last centers.
+// False if any event strays more than tolerance from that model or the boost fails.
+// For another observer, makeRigidBlock from the fitted lab_velocity and body is enough.
+template<typename T>
+bool fitRigidBlock(const std::vector<std::vector<T>>& frames, const T* observer_velocity, T tolerance, RigidBlockT<T>& out, int values_per_frame = 36);
+// Boosts only the first event of every frame (each needs one): centers gets (t', x', y', z')
+// per frame, still in t' order since t' grows with t along a worldline
+template<typename T>
+void boostRigidCenters(const RigidBlockT<T>& block, const std::vector<std::vector<T>>& frames, std::vector<T>& centers);
+// corners gets center + offsets[k] for every corner: the block at center's observer time
+template<typename T>
+void rigidCorners(const RigidBlockT<T>& block, const T* center, T* corners);
+
+// Capture history in half precision. Each frame keeps its first event (the block
+// center) as an fp32 origin and the other events as fp16/bf16 offsets from it, so corner
+// positions are stored relative to the block and timestamps relative to the frame's own.
+// A 9-event frame takes 80 bytes, against 144 plus a vector header (and its heap block)
+// as a std::vector<float>.
+class CompactHistory {
+public:
+    explicit CompactHistory(HalfFormat format = HALF_FP16, int values_per_frame = 36);
+
+    template<typename T> void append(const T* frame); // values_per_frame values
+    // Writes the first frames() frames of out (growing it if needed), in the layout
+    // saveVector and transformFrames take
+    template<typename T> void decode(std::vector<std::vector<T>>& out) const;
+    // Same as decode followed by transformFrames, but widened straight from the half values
+    BoostStatus transform(const float* velocity, std::vector<std::vector<float>>& out) const;
+    void reserve(size_t frame_count);
+    void clear();
+
+    size_t frames() const { return origins_.size() / 4; }
+    HalfFormat format() const { return format_; }
+    size_t bytes() const;      // bytes held by the history, reserved space included
+    size_t floatBytes() const; // bytes the same frames take as std::vector<std::vector<float>>, heap overhead not counted
+    double maxError() const { return max_error_; } // largest |decoded - appended| value so far
+
+private:
+    HalfFormat format_;
+    int values_per_frame_;
+    std::vector<float> origins_;   // (t,x,y,z) per frame
+    std::vector<uint16_t> values_; // values_per_frame - 4 per frame, events 1.. as offsets from the origin
+    double max_error_ = 0;
+};
+
+// raylib wants float, whatever the pipeline ran in. Allocated with new[].
+template<typename T>
+float* vectorToFloatPointer(const std::vector<T>& vec) {
+    float* result = new float[vec.size()]; //Allocate new memory
+    std::copy(vec.begin(), vec.end(), result); //Copy data
+    return result;
+}
+
+template<typename T>
+float* vectorToFloatPointer(const std::vector<T>& vec, FrameArena& arena) {
+    float* result = arena.alloc<float>(vec.size());
+    std::copy(vec.begin(), vec.end(), result);
+    return result;
+}
+
+#endif
@@ -0,0 +1,584 @@
+#include "event_store.h"
+#include "boost_kernels.h"
+#include "log.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <new>
+
+static const size_t CHUNK_ALIGNMENT = 64;
+
+// Bytes per chunk: four T columns, then the block and vertex id columns. Every column is
+// CHUNK_EVENTS long, so each starts on a 64-byte boundary.
+template<typename T>
+static size_t chunkBytes() {
+    return EventStoreT<T>::CHUNK_EVENTS * (4 * sizeof(T) + 2 * sizeof(uint32_t));
+}
+
+template<typename T>
+EventStoreT<T>::~EventStoreT() {
+    for (void* chunk : chunks_) {
+        if (chunk) {
+            ::operator delete(chunk, std::align_val_t(CHUNK_ALIGNMENT));
+        }
+    }
+    if (spill_.is_open()) {
+        spill_.close();
+        std::remove(spill_path_.c_str());
+    }
+}
+
+template<typename T>
+EventStoreT<T>::EventStoreT(EventStoreT&& other) noexcept {
+    *this = std::move(other);
+}
+
+// Swaps, so other's destructor releases whatever this held
+template<typename T>
+EventStoreT<T>& EventStoreT<T>::operator=(EventStoreT&& other) noexcept {
+    if (this != &other) {
+        std::swap(chunks_, other.chunks_);
+        std::swap(dirty_, other.dirty_);
+        std::swap(last_use_, other.last_use_);
+        std::swap(clock_, other.clock_);
+        std::swap(resident_, other.resident_);
+        spill_.swap(other.spill_);
+        std::swap(spill_path_, other.spill_path_);
+        std::swap(budget_chunks_, other.budget_chunks_);
+        std::swap(chunks_used_, other.chunks_used_);
+        std::swap(used_, other.used_);
+        std::swap(events_, other.events_);
+        std::swap(frame_begin_, other.frame_begin_);
+        std::swap(frame_end_, other.frame_end_);
+        std::swap(frame_overflow_, other.frame_overflow_);
+        std::swap(elide_static_, other.elide_static_);
+        std::swap(histories_, other.histories_);
+        std::swap(frame_time_, other.frame_time_);
+        std::swap(elided_events_, other.elided_events_);
+    }
+    return *this;
+}
+
+template<typename T>
+bool EventStoreT<T>::setSpill(const std::string& path, size_t ram_budget) {
+    if (ram_budget == 0) {
+        budget_chunks_ = 0;
+        return true;
+    }
+    if (!spill_.is_open()) {
+        spill_.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!spill_.is_open()) {
+            LOG_ERROR("EventStore: cannot open spill file " << path);
+            return false;
+        }
+        spill_path_ = path;
+    }
+    budget_chunks_ = std::max<size_t>(2, ram_budget / chunkBytes<T>());
+    // A lower budget takes effect now rather than on the next page-in
+    while (resident_ > budget_chunks_) {
+        size_t before = resident_;
+        ::operator delete(takeBuffer(chunks_.size()), std::align_val_t(CHUNK_ALIGNMENT));
+        if (resident_ == before) {
+            break; // only the chunk being filled is left
+        }
+    }
+    return true;
+}
+
+template<typename T>
+bool EventStoreT<T>::writeChunk(size_t chunk) const {
+    spill_.seekp((std::streamoff)(chunk * chunkBytes<T>()));
+    spill_.write(static_cast<const char*>(chunks_[chunk]), chunkBytes<T>());
+    if (!spill_) {
+        LOG_ERROR("EventStore: writing chunk " << chunk << " to " << spill_path_ << " failed, keeping it in memory");
+        spill_.clear();
+        return false;
+    }
+    dirty_[chunk] = 0;
+    return true;
+}
+
+// A buffer for chunk: the least recently used resident chunk's, written out first if
+// needed, once the budget is reached; otherwise a new one. The chunk being filled and
+// chunk itself are never evicted. Decrements resident_ when it evicts.
+template<typename T>
+void* EventStoreT<T>::takeBuffer(size_t chunk) const {
+    if (budget_chunks_ != 0 && resident_ >= budget_chunks_) {
+        size_t victim = chunks_.size();
+        for (size_t k = 0; k < chunks_.size(); k++) {
+            if (chunks_[k] && k != chunk && k + 1 != chunks_used_ &&
+                (victim == chunks_.size() || last_use_[k] < last_use_[victim])) {
+                victim = k;
+            }
+        }
+        if (victim < chunks_.size() && (!dirty_[victim] || writeChunk(victim))) {
+            void* buffer = chunks_[victim];
+            chunks_[victim] = nullptr;
+            resident_--;
+            return buffer;
+        }
+    }
+    return ::operator new(chunkBytes<T>(), std::align_val_t(CHUNK_ALIGNMENT));
+}
+
+template<typename T>
+typename EventStoreT<T>::Columns EventStoreT<T>::columns(size_t chunk) const {
+    if (!chunks_[chunk]) {
+        void* buffer = takeBuffer(chunk);
+        spill_.seekg((std::streamoff)(chunk * chunkBytes<T>()));
+        spill_.read(static_cast<char*>(buffer), chunkBytes<T>());
+        if (!spill_) {
+            LOG_ERROR("EventStore: reading chunk " << chunk << " from " << spill_path_ << " failed");
+            spill_.clear();
+            std::memset(buffer, 0, chunkBytes<T>());
+        }
+        chunks_[chunk] = buffer;
+        dirty_[chunk] = 0;
+        resident_++;
+    }
+    last_use_[chunk] = ++clock_;
+
+    char* base = static_cast<char*>(chunks_[chunk]);
+    Columns c;
+    c.t = reinterpret_cast<T*>(base);
+    c.x = c.t + CHUNK_EVENTS;
+    c.y = c.x + CHUNK_EVENTS;
+    c.z = c.y + CHUNK_EVENTS;
+    c.block = reinterpret_cast<uint32_t*>(c.z + CHUNK_EVENTS);
+    c.vertex = c.block + CHUNK_EVENTS;
+    return c;
+}
+
+// transform() runs over whole chunks but the last, so the unused end of a chunk is zeroed
+// rather than left uninitialised when the store moves on from it
+template<typename T>
+void EventStoreT<T>::zeroTail() {
+    Columns c = columns(chunks_used_ - 1);
+    size_t unused = CHUNK_EVENTS - used_;
+    std::memset(c.t + used_, 0, unused * sizeof(T));
+    std::memset(c.x + used_, 0, unused * sizeof(T));
+    std::memset(c.y + used_, 0, unused * sizeof(T));
+    std::memset(c.z + used_, 0, unused * sizeof(T));
+}
+
+template<typename T>
+void EventStoreT<T>::nextChunk() {
+    if (chunks_used_ > 0) {
+        zeroTail();
+    }
+    if (chunks_used_ == chunks_.size()) {
+        chunks_.push_back(nullptr);
+        dirty_.push_back(0);
+        last_use_.push_back(0);
+    }
+    size_t chunk = chunks_used_;
+    if (!chunks_[chunk]) {
+        // New, or a spare from clear() that was spilled: its old contents are not needed
+        chunks_[chunk] = takeBuffer(chunk);
+        resident_++;
+    }
+    dirty_[chunk] = 1;
+    last_use_[chunk] = ++clock_;
+    chunks_used_++;
+    used_ = 0;
+}
+
+template<typename T>
+void EventStoreT<T>::beginFrame(size_t expected_events) {
+    if (chunks_used_ == 0 || used_ == CHUNK_EVENTS || used_ + std::min(expected_events, CHUNK_EVENTS) > CHUNK_EVENTS) {
+        nextChunk();
+    }
+    size_t slot = (chunks_used_ - 1) * CHUNK_EVENTS + used_;
+    frame_begin_.push_back(slot);
+    frame_end_.push_back(slot);
+    frame_overflow_ = false;
+}
+
+template<typename T>
+bool EventStoreT<T>::append(uint32_t block, uint32_t vertex, T t, T x, T y, T z) {
+    if (frame_begin_.empty()) {
+        beginFrame();
+    }
+    size_t frame_events = frame_end_.back() - frame_begin_.back();
+    if (frame_events >= CHUNK_EVENTS) {
+        if (!frame_overflow_) {
+            LOG_ERROR("EventStore: frame " << frames() - 1 << " exceeds " << CHUNK_EVENTS << " events, dropping the rest");
+            frame_overflow_ = true;
+        }
+        return false;
+    }
+    if (used_ == CHUNK_EVENTS) {
+        // The frame outgrew its chunk: move what it has so far to the start of a new one
+        Columns from = columns(chunks_used_ - 1);
+        size_t offset = CHUNK_EVENTS - frame_events;
+        nextChunk();
+        Columns to = columns(chunks_used_ - 1);
+        std::memcpy(to.t, from.t + offset, frame_events * sizeof(T));
+        std::memcpy(to.x, from.x + offset, frame_events * sizeof(T));
+        std::memcpy(to.y, from.y + offset, frame_events * sizeof(T));
+        std::memcpy(to.z, from.z + offset, frame_events * sizeof(T));
+        std::memcpy(to.block, from.block + offset, frame_events * sizeof(uint32_t));
+        std::memcpy(to.vertex, from.vertex + offset, frame_events * sizeof(uint32_t));
+        used_ = frame_events;
+        frame_begin_.back() = (chunks_used_ - 1) * CHUNK_EVENTS;
+        frame_end_.back() = frame_begin_.back() + frame_events;
+    }
+
+    Columns c = columns(chunks_used_ - 1);
+    c.t[used_] = t;
+    c.x[used_] = x;
+    c.y[used_] = y;
+    c.z[used_] = z;
+    c.block[used_] = block;
+    c.vertex[used_] = vertex;
+    used_++;
+    frame_end_.back()++;
+    events_++;
+    return true;
+}
+
+// The rows repeat the block's positions in the previous frame, all at one t (the frame's,
+// if another block was elided in it already): extend its static run, or start one. Otherwise
+// remember the positions for the next frame; the caller stores the rows.
+template<typename T>
+bool EventStoreT<T>::elideStatic(uint32_t block, const T* rows, size_t count) {
+    if (block >= histories_.size()) {
+        histories_.resize(block + 1);
+    }
+    BlockHistory& history = histories_[block];
+    const size_t f = frames() - 1;
+    if (frame_time_.size() < frames()) {
+        frame_time_.resize(frames(), std::numeric_limits<T>::quiet_NaN());
+    }
+    const T t = rows[0];
+    bool repeat = history.seen && history.frame + 1 == f && history.positions.size() == count * 3 &&
+                  (std::isnan(frame_time_[f]) || frame_time_[f] == t);
+    for (size_t i = 0; repeat && i < count; i++) {
+        const T* e = rows + i * 4;
+        repeat = e[0] == t && e[1] == history.positions[i * 3] && e[2] == history.positions[i * 3 + 1] &&
+                 e[3] == history.positions[i * 3 + 2];
+    }
+    history.seen = true;
+    history.frame = f;
+    if (!repeat) {
+        history.positions.resize(count * 3);
+        for (size_t i = 0; i < count; i++) {
+            std::copy(rows + i * 4 + 1, rows + i * 4 + 4, history.positions.begin() + i * 3);
+        }
+        return false;
+    }
+
+    frame_time_[f] = t;
+    if (history.runs.empty() || history.runs.back().first_frame + history.runs.back().frames != f) {
+        StaticRun run;
+        run.first_frame = f;
+        run.frames = 0;
+        run.base.resize(count * 4);
+        for (size_t i = 0; i < count; i++) {
+            run.base[i * 4] = 0;
+            std::copy(rows + i * 4 + 1, rows + i * 4 + 4, run.base.begin() + i * 4 + 1);
+        }
+        run.direction[0] = 1;
+        run.direction[1] = run.direction[2] = run.direction[3] = 0;
+        history.runs.push_back(std::move(run));
+    }
+    history.runs.back().frames++;
+    elided_events_ += count;
+    return true;
+}
+
+template<typename T>
+bool EventStoreT<T>::appendRows(uint32_t block, const T* rows, size_t count) {
+    if (elide_static_ && !frame_begin_.empty() && count > 0 && elideStatic(block, rows, count)) {
+        return true;
+    }
+    if (!frame_begin_.empty() && used_ + count <= CHUNK_EVENTS) {
+        // Fits in the current chunk, so the frame stays put: write the columns directly
+        Columns c = columns(chunks_used_ - 1);
+        for (size_t i = 0; i < count; i++) {
+            c.t[used_ + i] = rows[i * 4];
+            c.x[used_ + i] = rows[i * 4 + 1];
+            c.y[used_ + i] = rows[i * 4 + 2];
+            c.z[used_ + i] = rows[i * 4 + 3];
+            c.block[used_ + i] = block;
+            c.vertex[used_ + i] = (uint32_t)i;
+        }
+        used_ += count;
+        frame_end_.back() += count;
+        events_ += count;
+        return true;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const T* e = rows + i * 4;
+        if (!append(block, (uint32_t)i, e[0], e[1], e[2], e[3])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+EventSpanT<T> EventStoreT<T>::frame(size_t index) const {
+    size_t begin = frame_begin_[index];
+    Columns c = columns(begin / CHUNK_EVENTS);
+    size_t offset = begin % CHUNK_EVENTS;
+    return {c.t + offset, c.x + offset, c.y + offset, c.z + offset, c.block + offset, c.vertex + offset,
+            frame_end_[index] - begin};
+}
+
+template<typename T>
+EventSpanT<T> EventStoreT<T>::frameBlock(size_t index, uint32_t block) const {
+    EventSpanT<T> span = frame(index);
+    size_t first = std::find(span.block, span.block + span.count, block) - span.block;
+    size_t last = first;
+    while (last < span.count && span.block[last] == block) {
+        last++;
+    }
+    return {span.t + first, span.x + first, span.y + first, span.z + first, span.block + first,
+            span.vertex + first, last - first};
+}
+
+// Runs are in frame order, so the one covering index is the last starting at or before it
+template<typename T>
+size_t EventStoreT<T>::staticRows(size_t index, uint32_t block, std::vector<T>& rows) const {
+    if (block >= histories_.size()) {
+        return 0;
+    }
+    const std::vector<StaticRun>& runs = histories_[block].runs;
+    auto after = std::upper_bound(runs.begin(), runs.end(), index,
+                                  [](size_t frame, const StaticRun& run) { return frame < run.first_frame; });
+    if (after == runs.begin() || index >= (after - 1)->first_frame + (after - 1)->frames) {
+        return 0;
+    }
+    const StaticRun& run = *(after - 1);
+    const T t = frame_time_[index];
+    size_t count = run.base.size() / 4;
+    rows.resize(count * 4);
+    for (size_t i = 0; i < count * 4; i++) {
+        rows[i] = run.base[i] + t * run.direction[i % 4];
+    }
+    return count;
+}
+
+template<typename T>
+size_t EventStoreT<T>::staticRuns() const {
+    size_t count = 0;
+    for (const BlockHistory& history : histories_) {
+        count += history.runs.size();
+    }
+    return count;
+}
+
+template<typename T>
+void EventStoreT<T>::blockFrames(uint32_t block, std::vector<std::vector<T>>& out) const {
+    out.resize(frames());
+    for (size_t f = 0; f < frames(); f++) {
+        if (staticRows(f, block, out[f]) > 0) {
+            continue;
+        }
+        EventSpanT<T> span = frameBlock(f, block);
+        out[f].resize(span.count * 4);
+        for (size_t i = 0; i < span.count; i++) {
+            out[f][i * 4] = span.t[i];
+            out[f][i * 4 + 1] = span.x[i];
+            out[f][i * 4 + 2] = span.y[i];
+            out[f][i * 4 + 3] = span.z[i];
+        }
+    }
+}
+
+template<typename T>
+bool EventStoreT<T>::saveBlockFrames(uint32_t block, const std::string& filename) const {
+    std::ofstream outFile(filename, std::ios::binary | std::ios::trunc);
+    size_t outerSize = frames();
+    outFile.write(reinterpret_cast<const char*>(&outerSize), sizeof(outerSize));
+    std::vector<T> rows;
+    for (size_t f = 0; f < frames(); f++) {
+        if (staticRows(f, block, rows) == 0) {
+            EventSpanT<T> span = frameBlock(f, block);
+            rows.resize(span.count * 4);
+            for (size_t i = 0; i < span.count; i++) {
+                rows[i * 4] = span.t[i];
+                rows[i * 4 + 1] = span.x[i];
+                rows[i * 4 + 2] = span.y[i];
+                rows[i * 4 + 3] = span.z[i];
+            }
+        }
+        size_t innerSize = rows.size();
+        outFile.write(reinterpret_cast<const char*>(&innerSize), sizeof(innerSize));
+        outFile.write(reinterpret_cast<const char*>(rows.data()), innerSize * sizeof(T));
+    }
+    if (!outFile) {
+        LOG_ERROR("EventStore: writing " << filename << " failed");
+        return false;
+    }
+    return true;
+}
+
+// A run's events are affine in lab time, so boosting the map boosts all its frames at once
+template<typename T>
+static void transformRun(const Mat4T<T>& boost, T* base, size_t count, T* direction) {
+    for (size_t i = 0; i <= count; i++) {
+        T* e = i < count ? base + i * 4 : direction;
+        T in[4] = {e[0], e[1], e[2], e[3]};
+        for (int r = 0; r < 4; r++) {
+            e[r] = boost.m[r][0] * in[0] + boost.m[r][1] * in[1] + boost.m[r][2] * in[2] + boost.m[r][3] * in[3];
+        }
+    }
+}
+
+template<typename T>
+void EventStoreT<T>::transform(const Mat4T<T>& boost) {
+    for (BlockHistory& history : histories_) {
+        for (StaticRun& run : history.runs) {
+            transformRun(boost, run.base.data(), run.base.size() / 4, run.direction);
+        }
+    }
+    if (chunks_used_ == 0) {
+        return;
+    }
+    auto boostChunk = [&](size_t k, const Columns& c) {
+        boostColumns(boost, c.t, c.x, c.y, c.z, k + 1 == chunks_used_ ? used_ : CHUNK_EVENTS);
+    };
+    if (budget_chunks_ != 0) {
+        // Paging a chunk in may evict the one before, so they go one at a time
+        for (size_t k = 0; k < chunks_used_; k++) {
+            boostChunk(k, columns(k));
+            dirty_[k] = 1;
+        }
+        return;
+    }
+    // Without a budget nothing is evicted, so the columns, taken here since columns() is
+    // not thread-safe, stay valid while the pool boosts a range of chunks per thread
+    std::vector<Columns> chunk_columns(chunks_used_);
+    for (size_t k = 0; k < chunks_used_; k++) {
+        chunk_columns[k] = columns(k);
+        dirty_[k] = 1;
+    }
+    WorkerPool& pool = WorkerPool::instance();
+    size_t parts = std::min<size_t>(pool.threads(), chunks_used_);
+    pool.run(parts, [&](size_t part) {
+        for (size_t k = chunks_used_ * part / parts; k < chunks_used_ * (part + 1) / parts; k++) {
+            boostChunk(k, chunk_columns[k]);
+        }
+    });
+}
+
+// Multi-observer counterpart of boostColumns, blocked over observers: a 16-event strip
+// of each input column is loaded once into L1 and every boost applied to it, in
+// boostColumns' arithmetic order so each output matches transform() bit for bit. outs holds four column
+// pointers (t, x, y, z) per boost. Inlined with n = MULTI_STRIP, the loops vectorize.
+static const size_t MULTI_STRIP = 16;
+
+template<typename T>
+static inline void transformStripMulti(const Mat4T<T>* boosts, size_t boost_count, const T* t, const T* x, const T* y, const T* z,
+                                       T* const* outs, size_t offset, size_t n) {
+    T et[MULTI_STRIP], ex[MULTI_STRIP], ey[MULTI_STRIP], ez[MULTI_STRIP];
+    for (size_t j = 0; j < n; j++) {
+        et[j] = t[offset + j];
+        ex[j] = x[offset + j];
+        ey[j] = y[offset + j];
+        ez[j] = z[offset + j];
+    }
+    for (size_t k = 0; k < boost_count; k++) {
+        for (int r = 0; r < 4; r++) {
+            const T mr0 = boosts[k].m[r][0], mr1 = boosts[k].m[r][1], mr2 = boosts[k].m[r][2], mr3 = boosts[k].m[r][3];
+            T* out = outs[k * 4 + r] + offset;
+            for (size_t j = 0; j < n; j++) {
+                out[j] = mr0 * et[j] + mr1 * ex[j] + mr2 * ey[j] + mr3 * ez[j];
+            }
+        }
+    }
+}
+
+template<typename T>
+static void transformColumnsMulti(const Mat4T<T>* boosts, size_t boost_count, const T* t, const T* x, const T* y, const T* z,
+                                  T* const* outs, size_t count) {
+    size_t i = 0;
+    for (; i + MULTI_STRIP <= count; i += MULTI_STRIP) {
+        transformStripMulti(boosts, boost_count, t, x, y, z, outs, i, MULTI_STRIP);
+    }
+    if (i < count) {
+        transformStripMulti(boosts, boost_count, t, x, y, z, outs, i, count - i);
+    }
+}
+
+template<typename T>
+void EventStoreT<T>::transformInto(const Mat4T<T>* boosts, size_t count, EventStoreT<T>* outs) const {
+    // Same frames, chunks and static runs as this store; only the events differ
+    for (size_t k = 0; k < count; k++) {
+        EventStoreT<T>& out = outs[k];
+        out.clear();
+        while (out.chunks_used_ < chunks_used_) {
+            out.used_ = CHUNK_EVENTS; // full, so nextChunk has no tail to zero
+            out.nextChunk();
+        }
+        out.used_ = used_;
+        out.events_ = events_;
+        out.frame_begin_ = frame_begin_;
+        out.frame_end_ = frame_end_;
+        out.frame_overflow_ = frame_overflow_;
+        out.elide_static_ = elide_static_;
+        out.histories_ = histories_;
+        out.frame_time_ = frame_time_;
+        out.elided_events_ = elided_events_;
+        for (BlockHistory& history : out.histories_) {
+            for (StaticRun& run : history.runs) {
+                transformRun(boosts[k], run.base.data(), run.base.size() / 4, run.direction);
+            }
+        }
+    }
+
+    // Observers in blocks of four, as boostEventsMulti takes them; past four the chunk is
+    // read again, from cache
+    const size_t BLOCK = 4;
+    for (size_t c = 0; c < chunks_used_; c++) {
+        Columns in = columns(c);
+        size_t n = c + 1 == chunks_used_ ? used_ : CHUNK_EVENTS;
+        for (size_t k = 0; k < count; k += BLOCK) {
+            size_t block = std::min(BLOCK, count - k);
+            T* out_columns[BLOCK * 4];
+            for (size_t j = 0; j < block; j++) {
+                EventStoreT<T>& out = outs[k + j];
+                Columns o = out.columns(c);
+                std::memcpy(o.block, in.block, n * sizeof(uint32_t));
+                std::memcpy(o.vertex, in.vertex, n * sizeof(uint32_t));
+                out_columns[j * 4] = o.t;
+                out_columns[j * 4 + 1] = o.x;
+                out_columns[j * 4 + 2] = o.y;
+                out_columns[j * 4 + 3] = o.z;
+                out.dirty_[c] = 1;
+            }
+            transformColumnsMulti(boosts + k, block, in.t, in.x, in.y, in.z, out_columns, n);
+        }
+    }
+}
+
+template<typename T>
+void EventStoreT<T>::clear() {
+    chunks_used_ = 0;
+    used_ = 0;
+    events_ = 0;
+    frame_begin_.clear();
+    frame_end_.clear();
+    frame_overflow_ = false;
+    histories_.clear();
+    frame_time_.clear();
+    elided_events_ = 0;
+}
+
+template<typename T>
+size_t EventStoreT<T>::bytes() const {
+    return resident_ * chunkBytes<T>();
+}
+
+template<typename T>
+size_t EventStoreT<T>::spilledBytes() const {
+    return (chunks_.size() - resident_) * chunkBytes<T>();
+}
+
+template class EventStoreT<float>;
+template class EventStoreT<double>;
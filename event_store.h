@@ -0,0 +1,154 @@
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "matrix_operations.h"
+
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+// Flat capture storage shared by the capture, transform and processing stages.
+// Events are kept as structure-of-arrays columns (t, x, y, z, block id, vertex id) in
+// 64-byte aligned chunks of CHUNK_EVENTS events. Chunks never move once allocated, so
+// appending never copies earlier frames, and a frame never straddles two chunks, so every
+// frame (and every block within a frame) is one contiguous run of each column.
+// The store is append-only and unbounded; with setSpill, chunks past a RAM budget go to a
+// file and come back on access, so a multi-hour capture runs in flat memory.
+// With setStaticElision, blocks that do not move are run-length encoded instead of stored
+// every frame.
+// Defined in event_store.cpp for float and double.
+
+// One contiguous run of events: column pointers plus a count. With a RAM budget set, the
+// pointers stay valid until the next store call that touches a different chunk.
+template<typename T>
+struct EventSpanT {
+    const T* t;
+    const T* x;
+    const T* y;
+    const T* z;
+    const uint32_t* block;
+    const uint32_t* vertex;
+    size_t count;
+};
+
+template<typename T>
+class EventStoreT {
+public:
+    static const size_t CHUNK_EVENTS = 4096;
+
+    EventStoreT() = default;
+    ~EventStoreT();
+    EventStoreT(EventStoreT&& other) noexcept;
+    EventStoreT& operator=(EventStoreT&& other) noexcept;
+    EventStoreT(const EventStoreT&) = delete;
+    EventStoreT& operator=(const EventStoreT&) = delete;
+
+    // Keeps at most ram_budget bytes of chunks in memory (never fewer than two chunks);
+    // the least recently used of the others are written to path, which the first call
+    // creates and the store removes when it is destroyed. 0 lifts the budget. False if
+    // path cannot be opened; the store then stays in memory.
+    bool setSpill(const std::string& path, size_t ram_budget);
+    // With it on, appendRows does not store a block whose rows repeat the positions of its
+    // rows in the previous frame (all at one t); the frame joins the block's static run
+    // instead: the rows once, as the map from lab time to event, plus the frame range. Reads
+    // (staticRows, blockFrames, processEvents) give the rows back, and transform() boosts
+    // each run once rather than its every frame.
+    void setStaticElision(bool on) { elide_static_ = on; }
+
+    // Starts a new frame. expected_events is a hint: a frame that would not fit in what
+    // is left of the current chunk starts a fresh one, rather than moving later.
+    void beginFrame(size_t expected_events = 0);
+    // Appends to the current frame (beginFrame first). False, and nothing stored, once a
+    // frame would exceed CHUNK_EVENTS events.
+    bool append(uint32_t block, uint32_t vertex, T t, T x, T y, T z);
+    // count packed (t,x,y,z) rows of one block, vertex ids 0..count-1: what insert_t gives
+    bool appendRows(uint32_t block, const T* rows, size_t count);
+
+    size_t frames() const { return frame_begin_.size(); }
+    size_t events() const { return events_; }
+    size_t chunkOf(size_t index) const { return frame_begin_[index] / CHUNK_EVENTS; } // frames go in chunk order
+    EventSpanT<T> frame(size_t index) const; // stored events only: not elided rows
+    // The block's stored events within one frame; count 0 if the block has none there.
+    // Assumes a block's events were appended together, as appendRows does.
+    EventSpanT<T> frameBlock(size_t index, uint32_t block) const;
+    // The block's rows in frame index if they were elided as static, as packed (t,x,y,z)
+    // rows in rows; the event count, 0 if they were not (frameBlock has them, or nothing does)
+    size_t staticRows(size_t index, uint32_t block, std::vector<T>& rows) const;
+    // Every frame's events of one block as packed (t,x,y,z) rows, the layout saveVector,
+    // transformFrames and processEvents take. out is resized to frames().
+    void blockFrames(uint32_t block, std::vector<std::vector<T>>& out) const;
+    // Writes the same rows straight to filename in saveVector's format, a frame at a time
+    bool saveBlockFrames(uint32_t block, const std::string& filename) const;
+
+    // Boosts every event in place, column by column (boostColumns: the axis path for an
+    // axis-aligned boost, sampled by interval validation), and every static run's map.
+    // Without a RAM budget the chunks are split across WorkerPool's threads.
+    void transform(const Mat4T<T>& boost);
+    // outs[k] becomes this store boosted by boosts[k], for count observers, with each chunk
+    // read once for all of them; this store is left as it is and must not be among outs. outs keep their spill settings.
+    void transformInto(const Mat4T<T>* boosts, size_t count, EventStoreT<T>* outs) const;
+    void clear();                 // drops the events, keeps the chunks for reuse
+    size_t bytes() const;         // bytes of chunks held in memory
+    size_t spilledBytes() const;  // bytes of chunks only on disk
+    size_t elidedEvents() const { return elided_events_; } // events static runs stand for, not in events()
+    size_t staticRuns() const;
+
+private:
+    struct Columns {
+        T* t;
+        T* x;
+        T* y;
+        T* z;
+        uint32_t* block;
+        uint32_t* vertex;
+    };
+    Columns columns(size_t chunk) const; // pages the chunk in if it was spilled
+    void* takeBuffer(size_t chunk) const;
+    bool writeChunk(size_t chunk) const;
+    void zeroTail();
+    void nextChunk();
+    bool elideStatic(uint32_t block, const T* rows, size_t count);
+
+    // Frames first_frame .. first_frame + frames - 1 of one block. Event i in frame f is
+    // base[i] + frame_time_[f] * direction: (0,x,y,z) and (1,0,0,0) until transform()
+    struct StaticRun {
+        size_t first_frame;
+        size_t frames;
+        std::vector<T> base; // 4 values per event
+        T direction[4];
+    };
+    struct BlockHistory {
+        bool seen = false;
+        size_t frame = 0;             // last frame the block was appended in, stored or elided
+        std::vector<T> positions;     // its (x,y,z) there
+        std::vector<StaticRun> runs;  // in frame order
+    };
+
+    // Chunk k lives at chunks_[k], or at k * chunk bytes in the spill file when that is null.
+    // Paging is invisible to callers, hence mutable.
+    mutable std::vector<void*> chunks_;
+    mutable std::vector<uint8_t> dirty_;       // changed since it was last written out
+    mutable std::vector<uint64_t> last_use_;   // for least-recently-used eviction
+    mutable uint64_t clock_ = 0;
+    mutable size_t resident_ = 0;
+    mutable std::fstream spill_;
+    std::string spill_path_;
+    size_t budget_chunks_ = 0;        // 0: no budget
+
+    size_t chunks_used_ = 0;          // chunks_[chunks_used_ - 1] is being filled; the rest are spares from clear()
+    size_t used_ = 0;                 // events used in that chunk
+    size_t events_ = 0;
+    std::vector<size_t> frame_begin_; // chunk * CHUNK_EVENTS + offset of the first event
+    std::vector<size_t> frame_end_;   // same, one past the last event
+    bool frame_overflow_ = false;     // the current frame hit CHUNK_EVENTS, already reported
+
+    bool elide_static_ = false;
+    std::vector<BlockHistory> histories_; // by block id, once static elision is on
+    std::vector<T> frame_time_;           // lab t of the frames with elided rows, NaN for the rest
+    size_t elided_events_ = 0;
+};
+
+using EventStore = EventStoreT<float>;
+
+#endif
@@ -684,7 +684,7 @@ int main(void)
     std::vector<std::vector<float>> events(FPS * MAX_DURATION); // Create a vector of vectors
 
 
-    auto rawloadedData = loadVector("events_data.bin");     std::vector<std::vector<float>> loadedData;     for (const auto& raw_corner_list : rawloadedData) {         loadedData.push_back( transformation( raw_corner_list.data(), observer_rel_velocity, 36)  );     }
+    auto loadedData = loadVector("events_data.bin");     for (auto& corner_list : loadedData) {         transformation( corner_list.data(), corner_list.data(), observer_rel_velocity, 36);     }
 
     auto processed_events = processEvents(loadedData); if (processed_events.empty()) return 2;
     auto block_points_array = process_to_points(processed_events);
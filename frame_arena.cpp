@@ -0,0 +1,64 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <new>
+
+FrameArena::FrameArena(size_t block_bytes) : block_bytes_(std::max<size_t>(block_bytes, ALIGNMENT)) {
+    blocks_.reserve(8); // a frame spilling into more blocks than this reallocates only the block list
+    addBlock(block_bytes_);
+}
+
+FrameArena::~FrameArena() {
+    for (Block& block : blocks_) {
+        ::operator delete(block.data, std::align_val_t(ALIGNMENT));
+    }
+}
+
+void FrameArena::addBlock(size_t bytes) {
+    bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    char* data = static_cast<char*>(::operator new(bytes, std::align_val_t(ALIGNMENT)));
+    blocks_.push_back({data, bytes});
+    heap_allocations_++;
+}
+
+size_t FrameArena::capacity() const {
+    size_t bytes = 0;
+    for (const Block& block : blocks_) {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+// Blocks start 64-byte aligned, so aligning the offset aligns the pointer for any
+// alignment up to ALIGNMENT
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    alignment = std::min<size_t>(std::max<size_t>(alignment, 1), ALIGNMENT);
+    size_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+    while (offset + bytes > blocks_[current_].size) {
+        current_++;
+        if (current_ == blocks_.size()) {
+            addBlock(std::max(block_bytes_, bytes));
+        }
+        offset = 0;
+    }
+    offset_ = offset + bytes;
+    frame_bytes_ += bytes;
+    frame_allocations_++;
+    return blocks_[current_].data + offset;
+}
+
+void FrameArena::reset() {
+    peak_bytes_ = std::max(peak_bytes_, frame_bytes_);
+    peak_allocations_ = std::max(peak_allocations_, frame_allocations_);
+    if (current_ > 0) {
+        size_t total = capacity();
+        for (Block& block : blocks_) {
+            ::operator delete(block.data, std::align_val_t(ALIGNMENT));
+        }
+        blocks_.clear();
+        addBlock(total);
+    }
+    current_ = 0;
+    offset_ = 0;
+    frame_bytes_ = 0;
+    frame_allocations_ = 0;
+}
@@ -0,0 +1,59 @@
+#include <cstddef>
+#include <vector>
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+// Frame-scoped bump allocator for the per-frame temporaries of the capture and replay
+// loops (insert_t rows, pts_to_vertices meshes, corner lists). Allocation bumps a pointer;
+// reset() at the end of the frame releases everything at once. Memory is kept across
+// frames, so once the arena has grown to a frame's worth, later frames never touch the heap.
+// Only for trivially destructible data: reset() runs no destructors.
+class FrameArena {
+public:
+    static const size_t ALIGNMENT = 64;
+
+    explicit FrameArena(size_t block_bytes = 64 << 10);
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Valid until the next reset(). Never null: a request that does not fit takes a new block.
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    template<typename T>
+    T* alloc(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // End of frame: every pointer handed out is invalid afterwards. If the frame needed
+    // more than one block they are merged into one that fits it, so the next frame bumps
+    // through a single block.
+    void reset();
+
+    size_t frameBytes() const { return frame_bytes_; }             // requested since the last reset
+    size_t frameAllocations() const { return frame_allocations_; } // allocate calls since the last reset
+    size_t peakBytes() const { return peak_bytes_; }               // largest frameBytes() of any frame
+    size_t peakAllocations() const { return peak_allocations_; }
+    size_t capacity() const;                                       // bytes held in blocks
+    size_t heapAllocations() const { return heap_allocations_; }   // blocks ever taken from the heap
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void addBlock(size_t bytes);
+
+    std::vector<Block> blocks_;
+    size_t block_bytes_;
+    size_t current_ = 0; // block being bumped through
+    size_t offset_ = 0;  // next free byte in it
+    size_t frame_bytes_ = 0;
+    size_t frame_allocations_ = 0;
+    size_t peak_bytes_ = 0;
+    size_t peak_allocations_ = 0;
+    size_t heap_allocations_ = 0;
+};
+
+#endif
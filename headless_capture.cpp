@@ -0,0 +1,146 @@
+// Headless capture-and-process batch mode: main.cpp's three-block scene (capture_scene.h) on
+// the fixed-step sim clock, with no window, stepped as fast as the CPU allows. No raylib
+// needed: build headless_capture.make (next to raylib-quickstart.make), or
+//   g++ -std=c++17 -O2 -pthread headless_capture.cpp capture_scene.cpp matrix_operations.cpp boost_kernels.cpp event_pipeline.cpp event_store.cpp capture_writer.cpp frame_arena.cpp worldline.cpp sim_clock.cpp worker_pool.cpp -o headless_capture
+//   ./headless_capture [sim seconds] [observer vx vy vz] [output prefix] [vx vy vz of more observers...]
+// Writes main's event files (<prefix>events_data.bin, <prefix>1events_data.bin, ...) and, per
+// block, <prefix>replay<b>.bin: in saveVector's layout, row 0 the replay mesh vertices
+// (CUBE_MESH_FLOATS per timestep), row 1 the centers (3 per timestep), row 2 the times.
+// Each further observer k gets <prefix>observer<k>_replay<b>.bin, all boosted in one pass.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "matrix_operations.h"
+#include "event_pipeline.h"
+#include "event_store.h"
+#include "capture_writer.h"
+#include "frame_arena.h"
+#include "worldline.h"
+#include "sim_clock.h"
+#include "capture_scene.h"
+#include "log.h"
+
+using batch_clock = std::chrono::steady_clock;
+
+static double secondsSince(batch_clock::time_point start) {
+    return std::chrono::duration<double>(batch_clock::now() - start).count();
+}
+
+// Scripted lab velocities at sim time t: block 0 at rest, block 1 cruising along x, block 2
+// turning back along y every 5 s
+static void scenarioVelocity(int block, double t, float* velocity) {
+    velocity[0] = velocity[1] = velocity[2] = 0;
+    if (block == 1) {
+        velocity[0] = 0.3f;
+    } else if (block == 2) {
+        velocity[1] = ((long)(t / 5) % 2 == 0) ? 0.2f : -0.2f;
+    }
+}
+
+int main(int argc, char** argv) {
+    double sim_seconds = argc > 1 ? std::atof(argv[1]) : 60;
+    std::vector<float> observer_velocities = {0.57f, 0, 0};
+    for (int i = 0; i < 3 && argc > 2 + i; i++) {
+        observer_velocities[i] = (float)std::atof(argv[2 + i]);
+    }
+    std::string prefix = argc > 5 ? argv[5] : "";
+    for (int i = 6; i + 2 < argc; i += 3) {
+        for (int j = 0; j < 3; j++) {
+            observer_velocities.push_back((float)std::atof(argv[i + j]));
+        }
+    }
+    const float* observer_velocity = observer_velocities.data();
+    std::vector<Mat4> observer_boosts(observer_velocities.size() / 3);
+    bool valid = sim_seconds > 0 && (argc <= 6 || (argc - 6) % 3 == 0);
+    for (size_t k = 0; k < observer_boosts.size(); k++) {
+        valid = valid && getBoostMat4(&observer_velocities[k * 3], observer_boosts[k]) == BOOST_OK;
+    }
+    if (!valid) {
+        std::cerr << "usage: " << argv[0] << " [sim seconds > 0] [observer vx vy vz, speed below 1] [output prefix] "
+                  << "[vx vy vz of more observers...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> event_files;
+    for (int b = 0; b < SCENE_BLOCKS; b++) {
+        event_files.push_back(prefix + (b == 0 ? "" : std::to_string(b)) + "events_data.bin");
+    }
+    EventStore events;
+    events.setStaticElision(true);
+    CaptureWriter capture_writer(event_files);
+    FrameArena frame_arena;
+    SimClock sim_clock(SIM_HZ);
+    Worldlines worldlines;
+    CaptureScene scene(worldlines);
+
+    // Capture: every step moves and records the blocks, every CAPTURE_EVERY_STEPS-th is sampled
+    auto start = batch_clock::now();
+    const uint64_t total_steps = (uint64_t)(sim_seconds * SIM_HZ);
+    while (sim_clock.steps() < total_steps) {
+        sim_clock.tick();
+        for (int b = 0; b < SCENE_BLOCKS; b++) {
+            float velocity[3];
+            scenarioVelocity(b, sim_clock.time(), velocity);
+            scene.setVelocity(b, velocity);
+        }
+        if (!scene.step(sim_clock)) continue;
+
+        if (!scene.captureFrame((float)sim_clock.time(), events, capture_writer, frame_arena)) {
+            LOG_ERROR("headless_capture: the event files miss the frame at t = " << sim_clock.time());
+            return 2;
+        }
+        frame_arena.reset();
+    }
+    double capture_time = secondsSince(start);
+    start = batch_clock::now();
+    capture_writer.close();
+    double write_time = secondsSince(start);
+
+    // Post-processing, as main does it once its window closes. One observer is boosted in
+    // place; several are written to their own stores in one pass over the capture.
+    start = batch_clock::now();
+    std::vector<EventStore> observed_events(observer_boosts.size() > 1 ? observer_boosts.size() : 0);
+    if (observed_events.empty()) {
+        events.transform(observer_boosts[0]);
+    } else {
+        events.transformInto(observer_boosts.data(), observer_boosts.size(), observed_events.data());
+    }
+    double transform_time = secondsSince(start);
+    start = batch_clock::now();
+    size_t replay_rows = 0;
+    for (size_t k = 0; k < observer_boosts.size(); k++) {
+        const EventStore& store = observed_events.empty() ? events : observed_events[k];
+        std::string replay_prefix = prefix + (k == 0 ? "" : "observer" + std::to_string(k) + "_");
+        for (int b = 0; b < SCENE_BLOCKS; b++) {
+            std::vector<std::vector<float>> replay(3);
+            if (!processVertices(store, b, replay[0], replay[1], replay[2])) {
+                LOG_ERROR("headless_capture: block " << b << " has no replay data");
+                return 2;
+            }
+            replay_rows += replay[2].size();
+            saveVector(replay, replay_prefix + "replay" + std::to_string(b) + ".bin");
+        }
+    }
+    double process_time = secondsSince(start);
+    Worldlines observed;
+    start = batch_clock::now();
+    if (worldlines.observe(observer_velocity, observed) != BOOST_OK) {
+        LOG_WARN("headless_capture: worldlines could not be observed");
+    }
+    double observe_time = secondsSince(start);
+
+    double total = capture_time + write_time + transform_time + process_time;
+    std::cout << sim_seconds << " sim seconds, " << sim_clock.steps() << " steps, " << events.frames() << " frames, "
+              << events.events() << " events stored, " << events.elidedEvents() << " elided as static in "
+              << events.staticRuns() << " runs" << std::endl;
+    std::cout << "  capture " << capture_time * 1e3 << " ms (" << sim_seconds / capture_time << "x real time, "
+              << events.events() / capture_time << " events/s), writer close " << write_time * 1e3 << " ms" << std::endl;
+    std::cout << "  transform (" << observer_boosts.size() << " observers) " << transform_time * 1e3 << " ms, process " << process_time * 1e3 << " ms ("
+              << replay_rows << " replay timesteps)" << std::endl;
+    std::cout << "  worldlines: " << worldlines.segments() << " segments, observed in " << observe_time * 1e3 << " ms"
+              << std::endl;
+    std::cout << "  total " << total * 1e3 << " ms, " << sim_seconds / total << "x real time" << std::endl;
+    return 0;
+}
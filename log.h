@@ -0,0 +1,52 @@
+#include <iostream>
+
+#ifndef LOG_H
+#define LOG_H
+
+// Levelled logging to stderr. Levels below LOG_LEVEL are removed by the preprocessor,
+// message expression and all, so they cost nothing in the build they are off in.
+// Debug builds default to everything, NDEBUG builds to warnings and errors.
+// Override with -DLOG_LEVEL=LOG_LEVEL_NONE etc.
+//   LOG_WARN("speed " << speed << " clamped");
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL LOG_LEVEL_WARN
+#else
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#define LOG_WRITE(tag, message) do { std::cerr << tag << message << '\n'; } while (0)
+#define LOG_DISCARD(message) do { } while (0)
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(message) LOG_WRITE("[debug] ", message)
+#else
+#define LOG_DEBUG(message) LOG_DISCARD(message)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(message) LOG_WRITE("[info] ", message)
+#else
+#define LOG_INFO(message) LOG_DISCARD(message)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(message) LOG_WRITE("[warn] ", message)
+#else
+#define LOG_WARN(message) LOG_DISCARD(message)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(message) LOG_WRITE("[error] ", message)
+#else
+#define LOG_ERROR(message) LOG_DISCARD(message)
+#endif
+
+#endif
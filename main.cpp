@@ -18,6 +18,14 @@
 #include <cstdlib>
 #include <cstring>
 #include "matrix_operations.h"
+#include "event_pipeline.h"
+#include "boost_kernels.h"
+#include "capture_writer.h"
+#include "frame_arena.h"
+#include "worldline.h"
+#include "sim_clock.h"
+#include "capture_scene.h"
+#include "log.h"
 #include <vector>
 #include <iostream>
 #include <algorithm>
@@ -27,6 +35,9 @@
 #include <limits> // Required for numeric_limits
 #define MAX_COLUMNS 1
 
+// Scalar type of the event pipeline. Use double for long or high-gamma sessions.
+typedef float Real;
+
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
@@ -49,343 +60,6 @@ std::vector<float> addVectorsCyclically(const std::vector<float>& vector1, const
   return result;
 }
 
-float* vectorToFloatPointer(std::vector<float> vec) {
-    float* result = new float[vec.size()]; //Allocate new memory
-    std::copy(vec.begin(), vec.end(), result); //Copy data
-    return result;
-}
-
-std::vector<float> lookup_row(const std::vector<float>& sorted_array, const std::vector<std::vector<float>>& data_matrix, float target_value) {
-    if (sorted_array.empty() || data_matrix.empty()) {
-        return {}; //Handle empty inputs
-    }
-
-    int index = std::upper_bound(sorted_array.begin(), sorted_array.end(), target_value) - sorted_array.begin() -1;
-
-    //Handle boundary conditions
-    if (index < 0) index = 0;
-    if (index >= sorted_array.size()) index = sorted_array.size() - 1;
-
-
-
-    return data_matrix[index];
-}
-
-std::vector<float> shift_array(const std::vector<float>& input) {
-    if (input.empty()) {
-        return {}; // Handle empty input
-    }
-
-    //Find the minimum element.  Handle potential NaN values.
-    float min_val = std::numeric_limits<float>::infinity();
-    for(float val : input){
-        if(val < min_val){
-            min_val = val;
-        }
-    }
-
-    float offset = 0.1f - min_val;
-    std::vector<float> shifted_array(input.size());
-
-    for (size_t i = 0; i < input.size(); ++i) {
-        shifted_array[i] = input[i] + offset;
-    }
-
-    return shifted_array;
-}
-
-
-std::vector<float> average_start_times(const std::vector<std::vector<std::vector<float>>>& result) {
-    int num_timesteps = result[0].size();
-    int num_groups = result.size();
-    std::vector<float> averages(num_timesteps);
-
-    for (int t = 0; t < num_timesteps; ++t) {
-        float sum = 0;
-        for (int g = 0; g < num_groups; ++g) {
-            sum +=  result[g][t][0];
-        }
-        averages[t] = sum / num_groups;
-    }
-
-    averages = shift_array(averages);
-    return averages;
-}
-// Helper function to check if a vector is all zeros
-bool isAllZeros(const std::vector<float>& vec) {
-    return std::all_of(vec.begin(), vec.end(), [](float f){ return f == 0.0f; });
-}
-
-void removeZeroVectors(std::vector<std::vector<std::vector<float>>>& data) {
-    for (auto& middle : data) {
-        // Use erase with remove_if for efficient removal
-        middle.erase(std::remove_if(middle.begin(), middle.end(), isAllZeros), middle.end());
-    }
-
-     // Optionally remove any now-empty middle vectors.  This is only needed if you
-     // want to get rid of middle vectors that became empty *after* removing
-     // the inner zero vectors.
-
-    data.erase(std::remove_if(data.begin(), data.end(), [](const std::vector<std::vector<float>>& middle){ return middle.empty(); }), data.end());
-}
-
-
-// Function to process events and return the reorganized data
-std::vector<std::vector<std::vector<float>>> processEvents(const std::vector<std::vector<float>>& events, int groups=9, int values_per_group=4)
-{
-    int events_size = events.size();
-    if (events.size() != events_size) {
-        std::cerr << "Error: Inconsistent events_size and events size." << std::endl;
-        //Return an empty std::vector to indicate an error.  Could throw an exception for better error handling
-        return {};
-    }
-
-    std::vector<std::vector<std::vector<float>>> new_vectors(groups);
-
-    for (int i = 0; i < groups; ++i) {
-        new_vectors[i].resize(events_size);
-        for (int j = 0; j < events_size; ++j) {
-            if (events[j].size() < (i + 1) * values_per_group) {
-                std::cerr << "Error: Insufficient elements in events[" << j << "]." << std::endl;
-                return {}; //Return an empty vector to indicate an error
-            }
-            new_vectors[i][j].resize(values_per_group);
-            for (int k = 0; k < values_per_group; ++k) {
-                new_vectors[i][j][k] = events[j][i * values_per_group + k];
-            }
-        }
-    }
-
-
-
-    for (int i = 0; i < groups; ++i) {
-        sort(new_vectors[i].begin(), new_vectors[i].end(), [](const std::vector<float>& a, const std::vector<float>& b) {
-            return a[0] < b[0];
-        });
-    }
-
-    // Find the group with the smallest first entry
-    int smallest_group_index = 0;
-    float smallest_first_entry = new_vectors[0][0][0];
-
-    for (size_t i = 1; i < new_vectors.size(); ++i) {
-        if (new_vectors[i][0][0] < smallest_first_entry) {
-            smallest_first_entry = new_vectors[i][0][0];
-            smallest_group_index = i;
-        }
-    }
-
-    std::cout << "The group with the smallest first entry (" << smallest_first_entry << ") is group " << smallest_group_index + 1 << std::endl;
-    // Find the group with the largest first entry
-    int largest_group_index = 0;
-    float largest_first_entry = new_vectors[0][0][0];
-
-    for (size_t i = 1; i < new_vectors.size(); ++i) {
-        if (new_vectors[i][0][0] > largest_first_entry) {
-            largest_first_entry = new_vectors[i][0][0];
-            largest_group_index = i;
-        }
-    }
-
-    std::cout << "The group with the largest first entry (" << largest_first_entry << ") is group " << largest_group_index + 1 << std::endl;
-
-    // Find the group with the largest and smallest first entries of the last row
-    size_t lastRowIndex = new_vectors[0].size() > 0 ? new_vectors[0].size() - 1 : 0; //Handle empty case
-
-    if (new_vectors.empty() || new_vectors[0].empty()) {
-        std::cout << "Error: new_vectors is empty" << std::endl;
-    }
-
-    size_t maxGroupIndex = 0;
-    float maxLastEntry = new_vectors[0][lastRowIndex][0];
-    size_t minGroupIndex = 0;
-    float minLastEntry = new_vectors[0][lastRowIndex][0];
-
-    for (size_t i = 1; i < new_vectors.size(); ++i) {
-        if (new_vectors[i][lastRowIndex][0] > maxLastEntry) {
-            maxLastEntry = new_vectors[i][lastRowIndex][0];
-            maxGroupIndex = i;
-        }
-        if (new_vectors[i][lastRowIndex][0] < minLastEntry) {
-            minLastEntry = new_vectors[i][lastRowIndex][0];
-            minGroupIndex = i;
-        }
-    }
-
-    std::cout << "The group with the largest last entry (" << maxLastEntry << ") is group " << maxGroupIndex + 1 << std::endl;
-    std::cout << "The group with the smallest last entry (" << minLastEntry << ") is group " << minGroupIndex + 1 << std::endl;
-
-    std::cout << std::min({maxLastEntry, largest_first_entry}) << std::endl;
-
-    for (auto& data : new_vectors) {
-        for (auto& row : data) { // Use a range-based for loop with a reference
-            if (!row.empty() && row[0] < largest_first_entry) {
-                row = {0.0f, 0.0f, 0.0f, 0.0f}; // Directly assign the new vector
-                //std::cout << row[0] << " " << row[1] << " " << row[2] << " " << row[3] << std::endl;
-            }
-        }
-    }
-
-    for (auto& data : new_vectors) {
-        for (auto& row : data) { // Use a range-based for loop with a reference
-            if (!row.empty() && row[0] > minLastEntry) {
-                row = {0.0f, 0.0f, 0.0f, 0.0f}; // Directly assign the new vector
-                //std::cout << row[0] << " " << row[1] << " " << row[2] << " " << row[3] << std::endl;
-            }
-        }
-    }
-
-    removeZeroVectors(new_vectors);
-
-
-    /*
-    // assume ascending, so kill the smallest in the front
-    for (int i=0; i < new_vectors.size(); ++i) {
-        for (int j=0; j < new_vectors[i].size(); ++j) {
-            if (new_vectors[i][j][0] < largest_first_entry) {
-                std::cout <<  ""  << std::endl;
-                std::cout << new_vectors[i][j][0] << std::endl;
-                //new_vectors[i][j] = {0,0,0,0};
-            }
-        }
-    }
-    for (int i = new_vectors[0].size() - 1; i >= 0; --i) {
-        for (int j = new_vectors[i][j].size() - 1; j >= 0; --j) {
-            if (new_vectors[i][j][0] > minLastEntry) {
-                std::cout << "d" << std::endl;
-                std::cout << new_vectors[i][j][0] << std::endl;
-                //new_vectors[i][j] = {0, 0, 0, 0};
-            }
-        }
-    } */
-
-
-
-    for(int i = 0; i < groups; ++i) {
-        //new_vectors[i][0][0];
-    }
-
-    /*
-    // 1. Print before sorting:
-    std::cout << "Before Sorting:" << std::endl;
-    for (int i = 0; i < groups; ++i) {
-        std::cout << "Group " << i + 1 << ":" << std::endl;
-        for (const auto& inner_vec : new_vectors[i]) {
-            for (float val : inner_vec) {
-                std::cout << val << " ";
-            }
-            std::cout << std::endl;
-        }
-        std::cout << std::endl;
-    }
-    */
-
-
-
-    return new_vectors;
-
-}
-
-std::vector<std::vector<float>> process_to_points(const std::vector<std::vector<std::vector<float>>>& input) {
-    int num_timesteps = input[0].size(); // Assumes all groups have the same number of time steps.
-    int num_groups = input.size();
-    //std::cout << "num_timesteps: " << num_groups << std::endl;
-    int values_per_group = input[0][0].size();
-
-    std::vector<std::vector<float>> points(num_timesteps);
-
-    for (int t = 0; t < num_timesteps; ++t) {
-        for (int g = 1; g < num_groups; ++g) {
-
-            std::vector<float> neg_center_pos = {0,0,0};
-            for(int i = 1; i < 4; ++i) {
-                neg_center_pos[i-1] = -1 * input[0][t][i];
-                //std::cout << neg_center_pos[i-1] << std::endl;
-            }
-
-
-            for (int i = 1; i < values_per_group; ++i) { // indices 1,2,3
-                points[t].push_back(input[g][t][i] - neg_center_pos[i-1] );
-            }
-        }
-    }
-
-    return points;
-}
-
-
-std::vector<std::vector<float>> get_lorentz_center_pos(const std::vector<std::vector<std::vector<float>>>& input) {
-    int num_timesteps = input[0].size(); // Assumes all groups have the same number of time steps.
-    int num_groups = input.size();
-    //std::cout << "num_timesteps: " << num_groups << std::endl;
-    int values_per_group = input[0][0].size();
-
-    std::vector<std::vector<float>> points(num_timesteps);
-
-    for (int t = 0; t < num_timesteps; ++t) {
-        for (int g = 0; g < 1; ++g) {
-
-            std::vector<float> neg_center_pos = {0,0,0};
-            for(int i = 1; i < 4; ++i) {
-                neg_center_pos[i-1] = -1 * input[0][t][i];
-                //std::cout << neg_center_pos[i-1] << std::endl;
-            }
-
-
-            for (int i = 1; i < values_per_group; ++i) { // indices 1,2,3
-                points[t].push_back(input[0][t][i]);
-            }
-        }
-    }
-
-    return points;
-}
-
-
-void saveVector(const std::vector<std::vector<float>>& vec, const std::string& filename) {
-    std::ofstream outFile(filename, std::ios::binary | std::ios::trunc);
-    size_t outerSize = vec.size();
-    outFile.write(reinterpret_cast<const char*>(&outerSize), sizeof(outerSize));
-    for (const auto& innerVec : vec) {
-        size_t innerSize = innerVec.size();
-        outFile.write(reinterpret_cast<const char*>(&innerSize), sizeof(innerSize));
-        outFile.write(reinterpret_cast<const char*>(innerVec.data()), innerSize * sizeof(float));
-    }
-}
-
-std::vector<std::vector<float>> loadVector(const std::string& filename) {
-    std::ifstream inFile(filename, std::ios::binary | std::ios::ate);
-    std::streamsize fileSize = inFile.tellg();
-    inFile.seekg(0, std::ios::beg);
-
-    size_t outerSize;
-    inFile.read(reinterpret_cast<char*>(&outerSize), sizeof(outerSize));
-
-    std::vector<std::vector<float>> vec(outerSize);
-
-    for (size_t i = 0; i < outerSize; ++i) {
-        size_t innerSize;
-        inFile.read(reinterpret_cast<char*>(&innerSize), sizeof(innerSize));
-
-        if (inFile.tellg() + static_cast<std::streamoff>(innerSize * sizeof(float)) > fileSize) {
-            std::cerr << "Read beyond file size!\n";
-            return {};
-        }
-
-        vec[i].resize(innerSize);
-        inFile.read(reinterpret_cast<char*>(vec[i].data()), innerSize * sizeof(float));
-    }
-        vec.erase(
-        std::remove_if(vec.begin(), vec.end(), [](const std::vector<float>& vec) {
-            return vec.empty();
-        }),
-        vec.end()
-    );
-
-    return vec;
-}
-
-
 Vector3 addVector3(Vector3 a, Vector3 b) {
     return (Vector3){ a.x + b.x, a.y + b.y, a.z + b.z };
 }
@@ -394,109 +68,6 @@ Vector3 scalarMultiplyVector3(Vector3 a, float b) {
     return (Vector3){ a.x * b, a.y * b, a.z * b  };
 }
 
-float* pts_to_vertices(float pts[], int pt_per_face) {
-    // Arrays for each face's vertices
-    float* vertices = new float[6 * 3 * pt_per_face];  // 6 faces, each having pt_per_face vertices with 3 components each
-
-    // 1. Copy top face (pts[0] to pts[pt_per_face-1])
-    std::copy(pts, pts + pt_per_face*3, vertices);
-
-    // 2. Copy bottom face (pts[pt_per_face] to pts[2*pt_per_face-1])
-    std::copy(pts + pt_per_face*3, pts + 2 * pt_per_face *3, vertices + pt_per_face *3);
-
-
-    int front_start_i = 2*pt_per_face*3;
-    int front_order[] = {5,3,2,6};
-    for (int i = 0; i < 4; ++i) {
-        // need the 4,0,1,7 vertices here
-        int which_vertex = front_order[i];
-        int start_of_vertex = which_vertex*3;
-
-        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +front_start_i  );
-        front_start_i += 3;
-   }
-
-
-    int back_start_i = 3*pt_per_face*3;
-    int back_order[] = {4,7,1,0};
-    for (int i = 0; i < 4; ++i) {
-        // need the 4,0,1,7 vertices here
-        int which_vertex = back_order[i];
-        int start_of_vertex = which_vertex*3;
-
-        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +back_start_i  );
-        back_start_i += 3;
-   }
-
-    int right_start_i = 4*pt_per_face*3;
-    int right_order[] = {7,6,2,1};
-    for (int i = 0; i < 4; ++i) {
-        // need the 4,0,1,7 vertices here
-        int which_vertex = right_order[i];
-        int start_of_vertex = which_vertex*3;
-
-        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +right_start_i  );
-        right_start_i += 3;
-   }
-
-    int left_start_i = 5*pt_per_face*3;
-    int left_order[] = {4,0,3,5};
-    for (int i = 0; i < 4; ++i) {
-        // need the 4,0,1,7 vertices here
-        int which_vertex = left_order[i];
-        int start_of_vertex = which_vertex*3;
-
-        std::copy( pts + start_of_vertex,   pts + start_of_vertex + 3, vertices +left_start_i  );
-        left_start_i += 3;
-   } /*
-
-
-    /*
-    const char* faces[] = {"Top", "Bottom", "Front", "Back", "Right", "Left"};
-    for (int i = 0; i < 6; ++i) {
-        std::cout << faces[i] << " face vertices: ";
-        for (int j = 0; j < pt_per_face*3; j+=3) {
-            std::cout << "(" << vertices[i * pt_per_face*3 + j] << ", " << vertices[i * pt_per_face*3 + j + 1] << ", " << vertices[i * pt_per_face*3 + j + 2] << ") ";
-        }
-        std::cout << std::endl;
-    }
-    */
-
-
-    return vertices;
-}
-
-
-std::vector<float> cube_vertices(float width, float height, float length, int pt_per_face){
-    // pt_per_face should be 4, as of now
-    int total_pts = 6 * pt_per_face * 3; // 6 faces then xyz for each point
-
-    float a = width; float b = height; float c = length;
-    float corner_vertices[] = {
-        // top face
-        -a/2, -b/2, c/2,
-        a/2, -b/2, c/2,
-        a/2, b/2, c/2,
-        -a/2, b/2, c/2,
-        // bottom face
-        -a/2, -b/2, -c/2,
-        -a/2, b/2, -c/2,
-        a/2, b/2, -c/2,
-        a/2, -b/2, -c/2,
-    };
-
-    std::vector<float> vertices;
-    vertices.reserve(total_pts); // Reserve space for efficiency
-
-    vertices.insert(vertices.end(), corner_vertices, corner_vertices + sizeof(corner_vertices)/sizeof(corner_vertices[0]));
-
-    //Assuming pts_to_vertices modifies the data in place and doesn't allocate new memory.
-    //If it does, the below line would need adjustment.
-    //If it allocates, you would have to manage that memory appropriately (copying data into vector)
-    //pts_to_vertices(vertices.data(), 4); //Modify in place, assuming it modifies the data passed
-    return vertices;
-};
-
 /*
 float* cube_vertices(float width, float height, float length, int pt_per_face){
     // pt_per_face should be 4, as of now
@@ -521,35 +92,6 @@ float* cube_vertices(float width, float height, float length, int pt_per_face){
 };
 */
 
-float *insert_t(const float *pts, int num_groups, float t) {
-    // Calculate the size of the new array.  Each group of 3 gets a 't' prepended,
-    // plus an extra 't' at the very end.
-
-    int new_size = num_groups * 4 + 1; // +1 for the extra t at the end
-
-    // Allocate memory for the new array.  Always check for allocation errors!
-    float *new_pts = (float *)malloc(new_size * sizeof(float));
-    if (new_pts == NULL) {
-        fprintf(stderr, "Memory allocation failed!\n");
-        return NULL; // Indicate failure
-    }
-
-    // Copy the data, inserting 't' before each group.
-    int new_index = 0;
-    for (int i = 0; i < num_groups; i++) {
-        new_pts[new_index++] = t;
-        new_pts[new_index++] = pts[i * 3];
-        new_pts[new_index++] = pts[i * 3 + 1];
-        new_pts[new_index++] = pts[i * 3 + 2];
-    }
-
-    // Add the final 't'.
-    new_pts[new_index] = t;
-
-
-    return new_pts;
-}
-
 
 Mesh GenMeshShape(float* vertices)
 {
@@ -654,6 +196,30 @@ Mesh GenMeshShape(float* vertices)
 
     return mesh;
 }
+
+// Draws the block where its worldline has it at time t, clamped to the recording. The mesh
+// is built the way the event replay builds its own (process_to_points, processVertices):
+// each vertex is the corner event plus the center, and the model is drawn at the center,
+// so both capture modes put the block in the same place.
+template<typename T>
+void drawWorldlineBlock(const WorldlinesT<T>& worldlines, uint32_t block, double t, FrameArena& arena){
+    const std::vector<WorldlineSegmentT<T>>& segments = worldlines.segments(block);
+    if (segments.empty()) return;
+    T time = std::min(std::max((T)t, segments.front().start[0]), segments.back().end);
+    size_t corner_count = worldlines.corners(block);
+    T* events = arena.alloc<T>((corner_count + 1) * 4);
+    worldlines.sample(block, time, events);
+    float* corners = arena.alloc<float>(corner_count * 3);
+    for (size_t k = 0; k < corner_count; k++) {
+        for (int i = 0; i < 3; i++) {
+            corners[k * 3 + i] = (float)(events[(k + 1) * 4 + 1 + i] + events[1 + i]);
+        }
+    }
+    Model model = LoadModelFromMesh(GenMeshShape(pts_to_vertices(corners, 4, arena)));
+    DrawModel(model, {(float)events[1], (float)events[2], (float)events[3]}, 1, RED);
+    UnloadModel(model);
+}
+
 int main(void)
 {
 
@@ -664,33 +230,51 @@ int main(void)
 
 
     std::cout << "e" << std::endl;
-    const double speed_of_light = 1.0;
-    Vector3 observer_abs_velocity = {0.57, 0., 0}; // now get the relative velocity
+    constexpr double speed_of_light = 1.0;
+    constexpr Vector3 observer_abs_velocity = {0.57, 0., 0}; // now get the relative velocity
     Vector3 observer_pos = {0,1,-20};
 
 
-    float observer_rel_velocity[3];
-    observer_rel_velocity[0] = observer_abs_velocity.x / speed_of_light; // x component
-    observer_rel_velocity[1] = observer_abs_velocity.y / speed_of_light; // y component
-    observer_rel_velocity[2] = observer_abs_velocity.z / speed_of_light; // z component
+    // The velocity is fixed, so the boost (gamma included) is folded at compile time
+    constexpr Mat4T<Real> observer_boost = boostMat4<Real>(observer_abs_velocity.x / speed_of_light,
+                                                           observer_abs_velocity.y / speed_of_light,
+                                                           observer_abs_velocity.z / speed_of_light);
     // now check that he ain't going faster than light
-    double magnitude_of_velocity = 0;
-    for (float i : observer_rel_velocity) {magnitude_of_velocity += i*i;}
-    magnitude_of_velocity = sqrt(magnitude_of_velocity);
-    if(magnitude_of_velocity >= 1.0) {std::cout << "Going too fast!!" << std::endl;return 1;}
+    static_assert(observer_boost.m[0][0] >= 1, "Going too fast!!");
     double frame_time = GetTime();
     double last_frame_time = GetTime();
     double time_diff; int frame_number = -1; // it gets incremented at the start
 
-    #define FPS 30
-    #define MAX_DURATION 60
+    #define FPS 30 // render rate; capture follows the sim clock below
+    #define MAX_DURATION 60 // expected session length in seconds, only used to reserve; longer ones just grow
+    #define CAPTURE_RAM_BUDGET (64 << 20) // bytes of captured events kept in RAM, older chunks spill to disk
+    #define COMPACT_HISTORY 0 // 1 captures into CompactHistory: fp16 offsets from the block center, about half the RAM
+    #define WORLDLINE_CAPTURE 0 // 1 keeps only the blocks' worldlines (a segment per velocity change) and replays from them
 
     // float **events =(float **)malloc(FPS * MAX_DURATION * 50* sizeof(float *));
 
-    // Use std::vector for safe and automatic memory management
-    std::vector<std::vector<float>> events(FPS * MAX_DURATION); // Create a vector of vectors
-    std::vector<std::vector<float>> events1(FPS * MAX_DURATION); // Create a vector of vectors
-    std::vector<std::vector<float>> events2(FPS * MAX_DURATION); // Create a vector of vectors
+    // Every frame's events for all three blocks (block ids 0, 1, 2) in one flat store,
+    // which the transform and processing below read in place
+    EventStoreT<Real> events;
+    events.setSpill("events_spill.bin", CAPTURE_RAM_BUDGET);
+    events.setStaticElision(true); // blocks at rest are kept as one run each, not every frame
+    // Streams each block's raw frames to its file while capturing, in saveVector's layout
+    CaptureWriterT<Real> capture_writer({"events_data.bin", "1events_data.bin", "2events_data.bin"});
+    size_t unwritten_frames = 0; // captured frames the writer refused for some block
+    // Per-frame temporaries (corner lists, meshes, insert_t rows), released at EndDrawing
+    FrameArena frame_arena;
+    // Motion, worldlines and capture run on sim time; the render loop only feeds it wall time
+    SimClock sim_clock(SIM_HZ);
+    // Each block's center worldline, which only grows when the block's velocity changes
+    WorldlinesT<Real> worldlines;
+    // The three blocks, stepped, recorded and captured as headless_capture does it
+    CaptureSceneT<Real> capture_scene(worldlines);
+#if COMPACT_HISTORY
+    CompactHistory history(HALF_FP16), history1(HALF_FP16), history2(HALF_FP16);
+    history.reserve(SIM_HZ / CAPTURE_EVERY_STEPS * MAX_DURATION);
+    history1.reserve(SIM_HZ / CAPTURE_EVERY_STEPS * MAX_DURATION);
+    history2.reserve(SIM_HZ / CAPTURE_EVERY_STEPS * MAX_DURATION);
+#endif
 
 
 
@@ -730,10 +314,6 @@ int main(void)
     SetTargetFPS(FPS);                   // Set our game to run at 60 frames-per-second
     //--------------------------------------------------------------------------------------
 
-    Vector3 block_pos = Vector3{-7,1,1};
-
-    Vector3 block_pos1 = Vector3{-7,1,1};
-    Vector3 block_pos2 = Vector3{-7,1,1};
     // Main game loop
     while (!WindowShouldClose())        // Detect window close button or ESC key
     {{
@@ -798,7 +378,6 @@ int main(void)
                 //DrawCube((Vector3){ 0.0f, 2.5f, 16.0f }, 32.0f, 5.0f, 1.0f, GOLD);      // Draw a yellow wall
 
                 DrawCube( observer_pos, 0.5,3,0.5, GOLD    );
-                observer_pos = addVector3(observer_pos, scalarMultiplyVector3(observer_abs_velocity, time_diff));
                 //camera.position = observer_pos;
 
 
@@ -812,61 +391,37 @@ int main(void)
 
 
 
-                Vector3 block_abs_velocity1 = {0,0.,0};
-                Vector3 block_abs_velocity2 = {0,0.,0};
-                Vector3 block_abs_velocity = {0,0.,0};
-                block_pos = addVector3(block_pos, scalarMultiplyVector3(block_abs_velocity, time_diff));
-                block_pos = addVector3(block_pos1, scalarMultiplyVector3(block_abs_velocity1, time_diff));
-                block_pos = addVector3(block_pos2, scalarMultiplyVector3(block_abs_velocity2, time_diff));
-                std::vector<float> block_pos_sv = {block_pos.x, block_pos.y, block_pos.z};
-                std::vector<float> block_pos_sv1 = {block_pos1.x, block_pos1.y, block_pos1.z};
-                std::vector<float> block_pos_sv2 = {block_pos2.x, block_pos2.y, block_pos2.z};
-
-                std::vector<float> corner_points1 = cube_vertices(9,4,5, 4);
-                std::vector<float> corner_points2 = cube_vertices(9,4,5, 4);
-
-                std::vector<float> corner_points = cube_vertices(9,4,5, 4);
-                float* vect_points = pts_to_vertices(corner_points.data(), 4);
-                float* vect_points1 = pts_to_vertices(corner_points1.data(), 4);
-                float* vect_points2 = pts_to_vertices(corner_points2.data(), 4);
-
-                corner_points = addVectorsCyclically(corner_points, block_pos_sv);
-                corner_points1 = addVectorsCyclically(corner_points1, block_pos_sv1);
-                corner_points2 = addVectorsCyclically(corner_points2, block_pos_sv2);
-                std::vector<float> prepended_corner_p = corner_points;
-                std::vector<float> prepended_corner_p1 = corner_points;
-                std::vector<float> prepended_corner_p2 = corner_points;
-
-                prepended_corner_p1.insert(prepended_corner_p1.begin(), block_pos_sv1.begin(), block_pos_sv1.end());
-                prepended_corner_p2.insert(prepended_corner_p2.begin(), block_pos_sv2.begin(), block_pos_sv2.end());
-                prepended_corner_p.insert(prepended_corner_p.begin(), block_pos_sv.begin(), block_pos_sv.end());
-
-                Model model = LoadModelFromMesh(GenMeshShape(vect_points));
-                Model model1 = LoadModelFromMesh(GenMeshShape(vect_points1));
-                Model model2 = LoadModelFromMesh(GenMeshShape(vect_points2));
-                DrawModel(model, block_pos, 1, RED);
-                DrawModel(model2, block_pos2, 1, RED);
-                DrawModel(model1, block_pos1, 1, RED);
-                delete[] vect_points; //stop memory leaks
-                delete[] vect_points2; //stop memory leaks
-                delete[] vect_points1; //stop memory leaks
-
-                int num_of_groups = 9;
-                int num_of_groups1 = 9;
-                int num_of_groups2 = 9;
-                float *events_array = insert_t(prepended_corner_p.data(), num_of_groups, GetTime());
-                float *events_array1 = insert_t(prepended_corner_p1.data(), num_of_groups1, GetTime());
-                float *events_array2 = insert_t(prepended_corner_p2.data(), num_of_groups2, GetTime());
-
-                int events_per_frame = num_of_groups * 4;
-                int events_per_frame1 = num_of_groups1 * 4;
-                int events_per_frame2 = num_of_groups2 * 4;
-                events[frame_number].resize(events_per_frame); // Resize the vector for this frame
-                events1[frame_number].resize(events_per_frame1); // Resize the vector for this frame
-                events2[frame_number].resize(events_per_frame2); // Resize the vector for this frame
-                std::copy(events_array, events_array + events_per_frame, events[frame_number].begin()); // Copy the data
-                std::copy(events_array1, events_array1 + events_per_frame1, events1[frame_number].begin()); // Copy the data
-                std::copy(events_array2, events_array2 + events_per_frame2, events2[frame_number].begin()); // Copy the data
+                float* vect_points = pts_to_vertices(capture_scene.body().data(), 4, frame_arena);
+
+                // Every sim step due by now, each a fixed SIM_HZ step however long the frame took
+                for (int due_steps = sim_clock.advance(GetFrameTime()); due_steps > 0; due_steps--) {
+                    sim_clock.tick();
+                    observer_pos = addVector3(observer_pos, scalarMultiplyVector3(observer_abs_velocity, sim_clock.step()));
+                    if (!capture_scene.step(sim_clock)) continue;
+
+#if !WORLDLINE_CAPTURE
+#if COMPACT_HISTORY
+                    CompactHistory* histories[SCENE_BLOCKS] = {&history, &history1, &history2};
+                    bool written = true;
+                    for (int b = 0; b < SCENE_BLOCKS; b++) {
+                        Real *events_array = capture_scene.blockEvents(b, sim_clock.time(), frame_arena);
+                        histories[b]->append(events_array);
+                        written = capture_writer.write(b, events_array, SCENE_BLOCK_EVENTS * 4) && written;
+                    }
+                    if (!written) unwritten_frames++;
+#else
+                    if (!capture_scene.captureFrame(sim_clock.time(), events, capture_writer, frame_arena)) unwritten_frames++;
+#endif
+#endif
+                }
+
+                for (int b = 0; b < SCENE_BLOCKS; b++) {
+                    const float* block_pos = capture_scene.position(b);
+                    Model model = LoadModelFromMesh(GenMeshShape(vect_points));
+                    DrawModel(model, {block_pos[0], block_pos[1], block_pos[2]}, 1, RED);
+                    UnloadModel(model); // drawn already, a fresh one is built next frame
+                }
+
 
                 //events[frame_number] = static_cast<float *>(malloc(events_per_frame * sizeof(float)));
                 //if (events[frame_number] == NULL){ std::cout << "Out of Memory" << std::endl;  return 1;}
@@ -901,15 +456,36 @@ int main(void)
 
 
         EndDrawing();
+        frame_arena.reset(); // this frame's temporaries are done with
         //----------------------------------------------------------------------------------
     }
 
 
 
 
-    saveVector(events, "events_data.bin");
-    saveVector(events1, "1events_data.bin");
-    saveVector(events2, "2events_data.bin");
+#if COMPACT_HISTORY
+    std::vector<std::vector<Real>> decoded, decoded1, decoded2;
+    history.decode(decoded);
+    history1.decode(decoded1);
+    history2.decode(decoded2);
+    for (size_t f = 0; f < history.frames(); f++) {
+        events.beginFrame((decoded[f].size() + decoded1[f].size() + decoded2[f].size()) / 4);
+        events.appendRows(0, decoded[f].data(), decoded[f].size() / 4);
+        events.appendRows(1, decoded1[f].data(), decoded1[f].size() / 4);
+        events.appendRows(2, decoded2[f].data(), decoded2[f].size() / 4);
+    }
+    LOG_INFO("compact history: " << history.bytes() + history1.bytes() + history2.bytes() << " bytes instead of "
+             << history.floatBytes() + history1.floatBytes() + history2.floatBytes() << ", max error "
+             << std::max({history.maxError(), history1.maxError(), history2.maxError()}));
+#endif
+    capture_writer.close();
+    LOG_INFO("frame arena: peak " << frame_arena.peakBytes() << " bytes in " << frame_arena.peakAllocations()
+             << " allocations per frame, " << frame_arena.heapAllocations() << " heap blocks");
+    LOG_INFO("capture writer: " << capture_writer.framesWritten() << " frames written, backlog peak "
+             << capture_writer.backlogPeak());
+    if (unwritten_frames > 0) {
+        LOG_ERROR("capture writer: " << unwritten_frames << " captured frames missing from the event files");
+    }
 
 
     // De-Initialization
@@ -919,35 +495,39 @@ int main(void)
 
 
 
-    auto rawloadedData = loadVector("events_data.bin");     std::vector<std::vector<float>> loadedData;     for (const auto& raw_corner_list : rawloadedData) {         loadedData.push_back( transformation( raw_corner_list.data(), observer_rel_velocity, 36)  );     }
-    auto rawloadedData1 = loadVector("1events_data.bin");     std::vector<std::vector<float>> loadedData1;     for (const auto& raw_corner_list1 : rawloadedData1) {         loadedData1.push_back( transformation( raw_corner_list1.data(), observer_rel_velocity, 36)  );     }
-    auto rawloadedData2 = loadVector("2events_data.bin");     std::vector<std::vector<float>> loadedData2;     for (const auto& raw_corner_list2 : rawloadedData2) {         loadedData2.push_back( transformation( raw_corner_list2.data(), observer_rel_velocity, 36)  );     }
-
-    auto processed_events = processEvents(loadedData); if (processed_events.empty()) return 2;
-    auto processed_events1 = processEvents(loadedData1); if (processed_events1.empty()) return 2;
-    auto processed_events2 = processEvents(loadedData2); if (processed_events2.empty()) return 2;
-    auto block_points_array = process_to_points(processed_events);
-    auto block_points_array1 = process_to_points(processed_events1);
-    auto block_points_array2 = process_to_points(processed_events2);
-    auto block_center_point = get_lorentz_center_pos(processed_events);
-    auto block_center_point1 = get_lorentz_center_pos(processed_events1);
-    auto block_center_point2 = get_lorentz_center_pos(processed_events2);
-    auto block_points_average_times = average_start_times(processed_events);
-    auto block_points_average_times1 = average_start_times(processed_events1);
-    auto block_points_average_times2 = average_start_times(processed_events2);
+#if WORLDLINE_CAPTURE
+    const Real observer_velocity[3] = {observer_abs_velocity.x / speed_of_light, observer_abs_velocity.y / speed_of_light,
+                                       observer_abs_velocity.z / speed_of_light};
+    WorldlinesT<Real> observed_worldlines;
+    if (worldlines.observe(observer_velocity, observed_worldlines) != BOOST_OK) return 2;
+    LOG_INFO("worldlines: " << worldlines.segments() << " segments in " << worldlines.bytes() << " bytes");
+#else
+    events.transform(observer_boost);
+    LOG_INFO("event store: " << events.events() << " events in " << events.frames() << " frames, " << events.bytes()
+             << " bytes in RAM, " << events.spilledBytes() << " spilled, " << events.elidedEvents()
+             << " static events in " << events.staticRuns() << " runs");
+    if (intervalValidation()) {
+        IntervalReport intervals = intervalReport();
+        LOG_INFO("interval check: " << intervals.pairs << " pairs in " << intervals.events << " checked events, "
+                 << intervals.check_seconds * 1e3 << " ms checking against " << intervals.kernel_seconds * 1e3
+                 << " ms boosting (" << (intervals.check_seconds > 0 ? intervals.pairs / intervals.check_seconds / 1e6 : 0)
+                 << " Mpairs/s), max relative error " << intervals.max_error);
+    }
+
+    std::vector<float> block_vertices, block_vertices1, block_vertices2;
+    std::vector<float> block_center_point, block_center_point1, block_center_point2;
+    std::vector<Real> block_points_average_times, block_points_average_times1, block_points_average_times2;
+    if (!processVertices(events, 0, block_vertices, block_center_point, block_points_average_times)) return 2;
+    if (!processVertices(events, 1, block_vertices1, block_center_point1, block_points_average_times1)) return 2;
+    if (!processVertices(events, 2, block_vertices2, block_center_point2, block_points_average_times2)) return 2;
 
         for (float avg : block_points_average_times) {
       //std::cout << avg << " " << std::endl;
     }
+#endif
 
 
 
-    for (const auto& row : block_points_array) {
-        for (double val : row) {
-            //std::cout << val << " ";
-        }
-        //std::cout << std::endl;  // Newline after each row
-    }
 
 
 
@@ -973,6 +553,7 @@ int main(void)
 
     SetTargetFPS(FPS);                   // Set our game to run at 60 frames-per-second
     //--------------------------------------------------------------------------------------
+    SimClock replay_clock(SIM_HZ);
 
 
     // Main game loop
@@ -1028,6 +609,12 @@ int main(void)
             time_diff = frame_time-last_frame_time;
             frame_number++;
             camera.position = (observer_pos, scalarMultiplyVector3(observer_abs_velocity, time_diff));
+            // The replay steps the same fixed SIM_HZ clock, from sim time 0 like the capture
+            for (int due_steps = replay_clock.advance(GetFrameTime()); due_steps > 0; due_steps--) {
+                replay_clock.tick();
+                observer_pos = addVector3(observer_pos, scalarMultiplyVector3(observer_abs_velocity, replay_clock.step()));
+            }
+            const double replay_time = replay_clock.time();
 
             ClearBackground(BLACK);
 
@@ -1037,26 +624,30 @@ int main(void)
 
 
                 DrawCube( observer_pos, 0.5,3,0.5, GOLD    );
-                observer_pos = addVector3(observer_pos, scalarMultiplyVector3(observer_abs_velocity, time_diff));
                 //camera.position = observer_pos;
 
 
-                float* lorentzed_corners = vectorToFloatPointer(lookup_row(block_points_average_times, block_points_array, frame_time));
-                float* lorentzed_corners1 = vectorToFloatPointer(lookup_row(block_points_average_times1, block_points_array1, frame_time));
-                float* lorentzed_corners2 = vectorToFloatPointer(lookup_row(block_points_average_times2, block_points_array2, frame_time));
-                float* lorentzed_center = vectorToFloatPointer(lookup_row(block_points_average_times, block_center_point , frame_time));
-                float* lorentzed_center1 = vectorToFloatPointer(lookup_row(block_points_average_times1, block_center_point1 , frame_time));
-                float* lorentzed_center2 = vectorToFloatPointer(lookup_row(block_points_average_times2, block_center_point2 , frame_time));
-                float* lorentzed_vect_points = pts_to_vertices(lorentzed_corners, 4);
-                float* lorentzed_vect_points1 = pts_to_vertices(lorentzed_corners1, 4);
-                float* lorentzed_vect_points2 = pts_to_vertices(lorentzed_corners2, 4);
-                Model lorentzed_model = LoadModelFromMesh(GenMeshShape(lorentzed_vect_points));
-                Model lorentzed_model1 = LoadModelFromMesh(GenMeshShape(lorentzed_vect_points1));
-                Model lorentzed_model2 = LoadModelFromMesh(GenMeshShape(lorentzed_vect_points2));
+#if WORLDLINE_CAPTURE
+                for (uint32_t b = 0; b < observed_worldlines.blocks(); b++) {
+                    drawWorldlineBlock(observed_worldlines, b, replay_time, frame_arena);
+                }
+#else
+                int lorentzed_row = lookup_index(block_points_average_times, replay_time);
+                int lorentzed_row1 = lookup_index(block_points_average_times1, replay_time);
+                int lorentzed_row2 = lookup_index(block_points_average_times2, replay_time);
+                float* lorentzed_center = &block_center_point[lorentzed_row * 3];
+                float* lorentzed_center1 = &block_center_point1[lorentzed_row1 * 3];
+                float* lorentzed_center2 = &block_center_point2[lorentzed_row2 * 3];
+                Model lorentzed_model = LoadModelFromMesh(GenMeshShape(&block_vertices[lorentzed_row * CUBE_MESH_FLOATS]));
+                Model lorentzed_model1 = LoadModelFromMesh(GenMeshShape(&block_vertices1[lorentzed_row1 * CUBE_MESH_FLOATS]));
+                Model lorentzed_model2 = LoadModelFromMesh(GenMeshShape(&block_vertices2[lorentzed_row2 * CUBE_MESH_FLOATS]));
                 DrawModel(lorentzed_model, {lorentzed_center[0], lorentzed_center[1], lorentzed_center[2]}, 1, RED);
                 DrawModel(lorentzed_model1, {lorentzed_center1[0], lorentzed_center1[1], lorentzed_center1[2]}, 1, RED);
                 DrawModel(lorentzed_model2, {lorentzed_center2[0], lorentzed_center2[1], lorentzed_center2[2]}, 1, RED);
-                delete[] lorentzed_corners; lorentzed_corners = nullptr;
+                UnloadModel(lorentzed_model);
+                UnloadModel(lorentzed_model1);
+                UnloadModel(lorentzed_model2);
+#endif
 
 
 
@@ -1071,6 +662,7 @@ int main(void)
 
 
         EndDrawing();
+        frame_arena.reset();
         //----------------------------------------------------------------------------------
     }
 
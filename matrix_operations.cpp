@@ -1,339 +1,559 @@
 #include "matrix_operations.h"
+#include "boost_kernels.h"
+#include "log.h"
 #include <cstdlib>
 #include <iostream>
 #include <cmath>
+#include <limits>
 # include <vector>
 
 
-// Matrix-Vector Multiplication
-float* matrixVectorMultiply(float mat1[][4], float mat2[][1]) {
-    const int R1 = 4, C1 = 4, R2 = 4, C2 = 1;
-    if (C1 != R2) {
-        return nullptr;
+// Copies an old-style 4x4 array into a Mat4
+static Mat4 toMat4(const float mat[][4]) {
+    Mat4 result;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.m[i][j] = mat[i][j];
+        }
     }
+    return result;
+}
 
-    float *result = (float*)malloc(R1 * C2 * sizeof(float));
+// Hands a value back to the pointer API, which expects a malloc'd buffer
+static float* toMallocBuffer(const float* values, int count) {
+    float* result = (float*)malloc(count * sizeof(float));
     if (result == nullptr) {
         return nullptr;
     }
-
-    for (int i = 0; i < R1; i++) {
-        result[i] = 0; // Initialize the result
-        for (int k = 0; k < C1; k++) {
-            result[i] += mat1[i][k] * mat2[k][0];
-        }
+    for (int i = 0; i < count; i++) {
+        result[i] = values[i];
     }
-
     return result;
 }
 
+// Matrix-Vector Multiplication
+float* matrixVectorMultiply(float mat1[][4], float mat2[][1]) {
+    Vec4 vec = {{mat2[0][0], mat2[1][0], mat2[2][0], mat2[3][0]}};
+    Vec4 result = mat4VectorMultiply(toMat4(mat1), vec);
+    return toMallocBuffer(result.v, 4);
+}
+
 // Matrix-Matrix Multiplication
 float* matrixMultiply(float mat1[][4], float mat2[][4]) {
-    const int R1 = 4, C1 = 4, R2 = 4, C2 = 4;
-    if (C1 != R2) {
-        return nullptr;
-    }
-
-    float *result = (float*)malloc(R1 * C2 * sizeof(float));
-    if (result == nullptr) {
-        return nullptr;
-    }
-
-    for (int i = 0; i < R1; i++) {
-        for (int j = 0; j < C2; j++) {
-            result[i * C2 + j] = 0;
-            for (int k = 0; k < C1; k++) {
-                result[i * C2 + j] += mat1[i][k] * mat2[k][j];
-            }
-        }
-    }
-
-    return result;
+    Mat4 result = mat4Multiply(toMat4(mat1), toMat4(mat2));
+    return toMallocBuffer(result.data(), 16);
 }
 
 // 3x3 Matrix Multiplication
 float* newMatrixMultiply(float mat1[][3], float mat2[][3]) {
-    const int R1 = 3, C1 = 3, R2 = 3, C2 = 3;
-    if (C1 != R2) {
-        return nullptr; // Incompatible matrix sizes
-    }
-
-    // Allocate memory for the result (3x3 matrix)
-    float *result = (float*)malloc(R1 * C2 * sizeof(float));
-    if (result == nullptr) {
-        return nullptr; // Memory allocation failed
-    }
-
-    // Perform matrix multiplication
-    for (int i = 0; i < R1; i++) {
-        for (int j = 0; j < C2; j++) {
-            result[i * C2 + j] = 0; // Initialize the result entry
-            for (int k = 0; k < C1; k++) {
-                result[i * C2 + j] += mat1[i][k] * mat2[k][j];
-            }
+    Mat3 a, b;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            a.m[i][j] = mat1[i][j];
+            b.m[i][j] = mat2[i][j];
         }
     }
-
-    return result;
+    Mat3 result = mat3Multiply(a, b);
+    return toMallocBuffer(&result.m[0][0], 9);
 }
 
 
-// Lorentz Matrix
-float* getLorentzMatrix(const float* velocity) {
-    float beta = std::sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
-
-    if (beta >= 1) {
-      std::cout << "is this it? Error in getLorentzMatrix: velocity[0] = " << velocity[0] << std::endl;
-        return nullptr;
+const char* boostStatusMessage(BoostStatus status) {
+    switch (status) {
+        case BOOST_OK: return "ok";
+        case BOOST_SPEED_NOT_BELOW_C: return "speed >= 1";
+        case BOOST_NOT_FINITE: return "velocity is not finite";
+        default: return "unknown boost status";
     }
+}
 
-    float gamma = 1.0f / std::sqrt(1.0f - beta * beta);
-
-    float* lorentzMatrix = (float*)malloc(16 * sizeof(float));
-    if (lorentzMatrix == nullptr) {
-        return nullptr;
+template<typename T>
+static BoostStatus speedStatus(T beta_squared) {
+    if (!std::isfinite(beta_squared)) {
+        return BOOST_NOT_FINITE;
     }
+    return beta_squared < 1 ? BOOST_OK : BOOST_SPEED_NOT_BELOW_C;
+}
 
-    for (int i = 0; i < 16; i++) {
-        lorentzMatrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+// Lorentz Matrix (boost along x with the full speed of the velocity)
+template<typename T>
+BoostStatus getLorentzMat4(const T* velocity, Mat4T<T>& out) {
+    T beta_squared = velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2];
+    BoostStatus status = speedStatus(beta_squared);
+    if (status != BOOST_OK) {
+        return status;
     }
 
-    lorentzMatrix[0] = gamma;
-    lorentzMatrix[1] = -gamma * beta;
-    lorentzMatrix[4] = -gamma * beta;
-    lorentzMatrix[5] = gamma;
+    T beta = std::sqrt(beta_squared);
+
+    T gamma = 1 / std::sqrt(1 - beta * beta);
 
+    out = identityMat4<T>();
+    out.m[0][0] = gamma;
+    out.m[0][1] = -gamma * beta;
+    out.m[1][0] = -gamma * beta;
+    out.m[1][1] = gamma;
 
+    return BOOST_OK;
+}
 
-    return lorentzMatrix;
+float* getLorentzMatrix(const float* velocity) {
+    Mat4 lorentz;
+    BoostStatus status = getLorentzMat4(velocity, lorentz);
+    if (status != BOOST_OK) {
+        LOG_ERROR("getLorentzMatrix: " << boostStatusMessage(status) << ", velocity[0] = " << velocity[0]);
+        return nullptr;
+    }
+    return toMallocBuffer(lorentz.data(), 16);
 }
 
 
+// Rotation Matrices: rot takes the velocity onto the x-axis, inverseRot takes it back.
+// The rotation is the quaternion q = (1 + c, v x x_hat) with c = v.x_hat, |q|^2 = 2 (1 + c).
+// Its only non-zero vector parts are y = v_z and z = -v_y, and expanding q x q* with
+// (1 + c)(1 - c) = v_y^2 + v_z^2 leaves
+//   R = [ v_x   v_y             v_z           ]
+//       [-v_y   1 - k v_y^2    -k v_y v_z     ]   k = (1 - v_x) / (v_y^2 + v_z^2)
+//       [-v_z  -k v_y v_z       1 - k v_z^2   ]
+// k is taken from v_y^2 + v_z^2 rather than 1 / (1 + c) so it stays accurate near v = -x_hat.
+// The parallel cases (zero velocity, v = +-x_hat) select k = 0 instead of branching, which
+// gives the identity and diag(-1, 1, 1) the old exact compares returned.
+template<typename T>
+void getRotMat4s(const T* velocity, Mat4T<T>& rot, Mat4T<T>& inverseRot) {
+    T magnitude = std::sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
+    T inverse_magnitude = magnitude > 0 ? 1 / magnitude : 0;
+
+    // Normalize the velocity vector, zero velocity becomes x_hat
+    T v_x = magnitude > 0 ? velocity[0] * inverse_magnitude : 1;
+    T v_y = velocity[1] * inverse_magnitude;
+    T v_z = velocity[2] * inverse_magnitude;
+
+    T perpendicular = v_y * v_y + v_z * v_z;
+    T k = perpendicular >= std::numeric_limits<T>::min() ? (1 - v_x) / perpendicular : 0;
+    T k_y = k * v_y;
+
+    rot = identityMat4<T>();
+    rot.m[1][1] = v_x;
+    rot.m[1][2] = v_y;
+    rot.m[1][3] = v_z;
+    rot.m[2][1] = -v_y;
+    rot.m[2][2] = 1 - k_y * v_y;
+    rot.m[2][3] = -k_y * v_z;
+    rot.m[3][1] = -v_z;
+    rot.m[3][2] = -k_y * v_z;
+    rot.m[3][3] = 1 - k * v_z * v_z;
+
+    inverseRot = transposeMat4(rot);
+}
 
+// Original Rodrigues construction, kept to benchmark getRotMat4s against
+template<typename T>
+void getRotMat4sRodrigues(const T* velocity, Mat4T<T>& rot, Mat4T<T>& inverseRot) {
+    rot = identityMat4<T>();
+    inverseRot = identityMat4<T>();
 
-// Rotation Matrices
-float** getRotMatrices(const float* velocity) {
-    float** matrices = (float**)malloc(2 * sizeof(float*));
-    matrices[0] = (float*)malloc(16 * sizeof(float)); // Rotation matrix
-    matrices[1] = (float*)malloc(16 * sizeof(float)); // Inverse rotation matrix
-    // Ensure the velocity vector is normalized (magnitude == 1)
-    float magnitude = std::sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
+    T magnitude = std::sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
     if (magnitude == 0) {
-        matrices[0][0] = 1.0f; matrices[0][1] = 0.0f; matrices[0][2] = 0.0f; matrices[0][3] = 0.0f;
-        matrices[0][4] = 0.0f; matrices[0][5] = 1.0f; matrices[0][6] = 0.0f; matrices[0][7] = 0.0f;
-        matrices[0][8] = 0.0f; matrices[0][9] = 0.0f; matrices[0][10] = 1.0f; matrices[0][11] = 0.0f;
-        matrices[0][12] = 0.0f; matrices[0][13] = 0.0f; matrices[0][14] = 0.0f; matrices[0][15] = 1.0f;
-        for (int i = 0; i < 16; i++) {
-            matrices[1][i] = matrices[0][i];
-        }
-        return matrices; // Invalid input: zero vector
+        return; // Invalid input: zero vector
     }
 
     // Normalize the velocity vector
-    float v_x = velocity[0] / magnitude;
-    float v_y = velocity[1] / magnitude;
-    float v_z = velocity[2] / magnitude;
+    T v_x = velocity[0] / magnitude;
+    T v_y = velocity[1] / magnitude;
+    T v_z = velocity[2] / magnitude;
+
+    // Angle of rotation (theta) between the x-axis and the velocity
+    T cos_theta = v_x; // since the x-axis is (1, 0, 0)
+    if (cos_theta == 1) {
+        return;
+    }
+
+    if (cos_theta == -1) {
+        rot.m[1][1] = -1;
+        inverseRot.m[1][1] = -1;
+        return;
+    }
 
     // Axis of rotation: perpendicular to the velocity (cross product with x-axis)
-    float axis_x = 0;
-    float axis_y = v_z;
-    float axis_z = -v_y;
+    T axis_x = 0;
+    T axis_y = v_z;
+    T axis_z = -v_y;
 
     // Normalize the axis vector
-    float axis_magnitude = std::sqrt(axis_x * axis_x + axis_y * axis_y + axis_z * axis_z);
+    T axis_magnitude = std::sqrt(axis_x * axis_x + axis_y * axis_y + axis_z * axis_z);
     axis_x /= axis_magnitude;
     axis_y /= axis_magnitude;
     axis_z /= axis_magnitude;
 
-    // Angle of rotation (theta) between the x-axis and the velocity
+    T sin_theta = std::sqrt(1 - cos_theta * cos_theta);
+
+    // Cross product matrix (K)
+    Mat3T<T> K = {{
+        {0, -axis_z, axis_y},
+        {axis_z, 0, -axis_x},
+        {-axis_y, axis_x, 0}
+    }};
+    Mat3T<T> K_squared = mat3Multiply(K, K);
 
-    float cos_theta = v_x; // since the x-axis is (1, 0, 0)
-    if (cos_theta == 1.0f) {
-        matrices[0][0] = 1.0f; matrices[0][1] = 0.0f; matrices[0][2] = 0.0f; matrices[0][3] = 0.0f;
-        matrices[0][4] = 0.0f; matrices[0][5] = 1.0f; matrices[0][6] = 0.0f; matrices[0][7] = 0.0f;
-        matrices[0][8] = 0.0f; matrices[0][9] = 0.0f; matrices[0][10] = 1.0f; matrices[0][11] = 0.0f;
-        matrices[0][12] = 0.0f; matrices[0][13] = 0.0f; matrices[0][14] = 0.0f; matrices[0][15] = 1.0f;
-        for (int i = 0; i < 16; i++) {
-            matrices[1][i] = matrices[0][i];
+    // Rotation matrix R (using Rodrigues' formula): I + sin(theta) K + (1 - cos(theta)) K^2
+    Mat3T<T> R = identityMat3<T>();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            R.m[i][j] += sin_theta * K.m[i][j] + (1 - cos_theta) * K_squared.m[i][j];
         }
-        return matrices;
     }
 
-    if (cos_theta == -1.0f) {
-        matrices[0][0] = 1.0f; matrices[0][1] = 0.0f; matrices[0][2] = 0.0f; matrices[0][3] = 0.0f;
-        matrices[0][4] = 0.0f; matrices[0][5] = -1.0f; matrices[0][6] = 0.0f; matrices[0][7] = 0.0f;
-        matrices[0][8] = 0.0f; matrices[0][9] = 0.0f; matrices[0][10] = 1.0f; matrices[0][11] = 0.0f;
-        matrices[0][12] = 0.0f; matrices[0][13] = 0.0f; matrices[0][14] = 0.0f; matrices[0][15] = 1.0f;
-        for (int i = 0; i < 16; i++) {
-            matrices[1][i] = matrices[0][i];
+    // Fill in the spatial block of the homogeneous matrices
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            rot.m[i + 1][j + 1] = R.m[i][j];
+            inverseRot.m[i + 1][j + 1] = R.m[j][i];  // Inverse rotation (transpose)
         }
-        return matrices;
     }
+}
 
+float** getRotMatrices(const float* velocity) {
+    Mat4 rot, inverseRot;
+    getRotMat4s(velocity, rot, inverseRot);
 
-    float sin_theta = std::sqrt(1 - cos_theta * cos_theta);
+    float** matrices = (float**)malloc(2 * sizeof(float*));
+    if (matrices == nullptr) {
+        return nullptr;
+    }
+    matrices[0] = toMallocBuffer(rot.data(), 16);        // Rotation matrix
+    matrices[1] = toMallocBuffer(inverseRot.data(), 16); // Inverse rotation matrix
+    if (matrices[0] == nullptr || matrices[1] == nullptr) {
+        free(matrices[0]);
+        free(matrices[1]);
+        free(matrices);
+        return nullptr;
+    }
+    return matrices;
+}
 
-    // Cross product matrix (K)
-    float K[3][3] = {
-        {0, -axis_z, axis_y},
-        {axis_z, 0, -axis_x},
-        {-axis_y, axis_x, 0}
-    };
+// The resulting matrix A_f = R^T * A_o * R
+template<typename T>
+BoostStatus getFinalMat4(const T* velocity, Mat4T<T>& out) {
+    Mat4T<T> rot, inverseRot, lorentz;
+    getRotMat4s(velocity, rot, inverseRot);
+    BoostStatus status = getLorentzMat4(velocity, lorentz);
+    if (status != BOOST_OK) {
+        return status;
+    }
 
-    // K^2 (K matrix multiplied by itself)
-    float* K_squared = newMatrixMultiply(K, K);
+    out = mat4Multiply(inverseRot, mat4Multiply(lorentz, rot));
+    return BOOST_OK;
+}
 
-    // Rotation matrix R (using Rodrigues' formula)
-    float R[3][3] = {0};
+float* getFinalMatrix(float* velocity) {
+    Mat4 final;
+    BoostStatus status = getFinalMat4(velocity, final);
+    if (status != BOOST_OK) {
+        LOG_ERROR("getFinalMatrix: " << boostStatusMessage(status));
+        return nullptr;
+    }
+    return toMallocBuffer(final.data(), 16);
+}
 
-    // Identity matrix contribution
-    for (int i = 0; i < 3; i++) {
-        R[i][i] = 1.0f;
+// Direct boost builder: evaluates the general boost matrix in one pass instead of R^T * A_o * R
+//   A[0][0] = gamma, A[0][i] = A[i][0] = -gamma * beta_i
+//   A[i][j] = delta_ij + (gamma - 1) * beta_i * beta_j / beta^2
+// (gamma - 1) / beta^2 is rewritten as gamma^2 / (1 + gamma) so beta = 0 needs no special case.
+template<typename T>
+BoostStatus getBoostMat4(const T* velocity, Mat4T<T>& out) {
+    T beta_squared = velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2];
+    BoostStatus status = speedStatus(beta_squared);
+    if (status != BOOST_OK) {
+        return status;
     }
 
-    // Adding sin(theta) * K
+    T gamma = 1 / std::sqrt(1 - beta_squared);
+    T k = gamma * gamma / (1 + gamma);
+
+    out.m[0][0] = gamma;
     for (int i = 0; i < 3; i++) {
+        out.m[0][i + 1] = -gamma * velocity[i];
+        out.m[i + 1][0] = -gamma * velocity[i];
         for (int j = 0; j < 3; j++) {
-            R[i][j] += sin_theta * K[i][j];
+            out.m[i + 1][j + 1] = (i == j ? 1 : 0) + k * velocity[i] * velocity[j];
         }
     }
+    return BOOST_OK;
+}
+
+float* getBoostMatrix(float* velocity) {
+    Mat4 boost;
+    BoostStatus status = getBoostMat4(velocity, boost);
+    if (status != BOOST_OK) {
+        LOG_ERROR("getBoostMatrix: " << boostStatusMessage(status));
+        return nullptr;
+    }
+    return toMallocBuffer(boost.data(), 16);
+}
+
+// atanh(beta) as 0.5 * log1p(2 beta / (1 - beta)). 1 - beta is exact for beta near 1,
+// unlike 1 - beta^2, so this keeps all the precision the input velocity has.
+template<typename T>
+BoostStatus rapidityFromVelocity(const T* velocity, RapidityT<T>& out) {
+    T beta_squared = velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2];
+    BoostStatus status = speedStatus(beta_squared);
+    T beta = std::sqrt(beta_squared);
+    if (status == BOOST_OK && beta >= 1) {
+        status = BOOST_SPEED_NOT_BELOW_C; // beta^2 just below 1 can still round to beta = 1
+    }
+    if (status != BOOST_OK) {
+        return status;
+    }
 
-    // Adding (1 - cos(theta)) * K^2
+    out.eta = T(0.5) * std::log1p(2 * beta / (1 - beta));
     for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            R[i][j] += (1 - cos_theta) * K_squared[i * 3 + j];
-        }
+        out.direction[i] = beta > 0 ? velocity[i] / beta : 0;
     }
+    return BOOST_OK;
+}
 
-    // Now, we need to convert R (a 3x3 matrix) into a 4x4 matrix for homogeneous coordinates
-    matrices[0] = (float*)malloc(16 * sizeof(float)); // Rotation matrix
-    matrices[1] = (float*)malloc(16 * sizeof(float)); // Inverse rotation matrix
+template<typename T>
+RapidityT<T> rapidityFromGamma(T gamma, const T* direction) {
+    RapidityT<T> out;
+    T length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    // acosh(gamma), with gamma^2 - 1 as (gamma - 1)(gamma + 1) so gamma near 1 does not cancel
+    out.eta = gamma > 1 && length > 0 ? std::log(gamma + std::sqrt((gamma - 1) * (gamma + 1))) : 0;
+    for (int i = 0; i < 3; i++) {
+        out.direction[i] = out.eta > 0 ? direction[i] / length : 0;
+    }
+    return out;
+}
 
-    // Initialize as identity matrices
-    for (int i = 0; i < 16; i++) {
-        matrices[0][i] = matrices[1][i] = (i % 5 == 0) ? 1.0f : 0.0f;
+template<typename T>
+RapidityT<T> addCollinearRapidity(const RapidityT<T>& rapidity, T eta) {
+    RapidityT<T> out = rapidity;
+    out.eta += eta;
+    if (out.eta < 0) {
+        out.eta = -out.eta;
+        for (int i = 0; i < 3; i++) {
+            out.direction[i] = -out.direction[i];
+        }
     }
+    return out;
+}
 
-    // Fill in the rotation matrix (top-left 3x3 block)
+template<typename T>
+void rapidityToVelocity(const RapidityT<T>& rapidity, T* velocity) {
+    T beta = std::tanh(rapidity.eta);
     for (int i = 0; i < 3; i++) {
+        velocity[i] = beta * rapidity.direction[i];
+    }
+}
+
+// Same matrix as getBoostMat4(velocity), from cosh/sinh. gamma - 1 is taken as
+// 2 sinh^2(eta / 2) so small rapidities keep their precision too.
+template<typename T>
+void getBoostMat4(const RapidityT<T>& rapidity, Mat4T<T>& out) {
+    T gamma = std::cosh(rapidity.eta);
+    T gamma_beta = std::sinh(rapidity.eta);
+    T half = std::sinh(rapidity.eta / 2);
+    T gamma_minus_one = 2 * half * half;
+    const T* n = rapidity.direction;
+
+    out.m[0][0] = gamma;
+    for (int i = 0; i < 3; i++) {
+        out.m[0][i + 1] = -gamma_beta * n[i];
+        out.m[i + 1][0] = -gamma_beta * n[i];
         for (int j = 0; j < 3; j++) {
-            matrices[0][(i + 1) * 4 + (j + 1)] = R[i][j];
-            matrices[1][(i + 1) * 4 + (j + 1)] = R[j][i];  // Inverse rotation (transpose)
+            out.m[i + 1][j + 1] = (i == j ? 1 : 0) + gamma_minus_one * n[i] * n[j];
         }
     }
+}
 
-    return matrices;
+// u (+) v = (u + v / gamma_u + gamma_u / (1 + gamma_u) (u.v) u) / (1 + u.v)
+template<typename T>
+void addVelocities(const T* u, const T* v, T* out) {
+    T u_dot_v = u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+    T gamma_u = 1 / std::sqrt(1 - (u[0] * u[0] + u[1] * u[1] + u[2] * u[2]));
+    T k = gamma_u / (1 + gamma_u) * u_dot_v;
+    for (int i = 0; i < 3; i++) {
+        out[i] = (u[i] + v[i] / gamma_u + k * u[i]) / (1 + u_dot_v);
+    }
 }
 
-// New function to get the resulting matrix A_f
-float* getFinalMatrix(float* velocity) {
-    // Get the rotation matrices
-    float** matrices = getRotMatrices(velocity);
-    if (matrices == nullptr) {
-      std::cout << "Error in getFinalMatrix()" << std::endl;
-        return nullptr; // Handle the case when rotation matrices are invalid
+// Row 0 of wigner * boost is row 0 of the boost, which gives gamma and gamma * beta
+// without going through beta. boost^-1 is the same boost with the mixed terms negated.
+template<typename T>
+void decomposeLorentz(const Mat4T<T>& lorentz, BoostCompositionT<T>& out) {
+    T gamma = lorentz.m[0][0];
+    T gamma_beta[3] = {-lorentz.m[0][1], -lorentz.m[0][2], -lorentz.m[0][3]};
+
+    Mat4T<T> inverse_boost;
+    out.boost.m[0][0] = inverse_boost.m[0][0] = gamma;
+    for (int i = 0; i < 3; i++) {
+        out.velocity[i] = gamma_beta[i] / gamma;
+        out.boost.m[0][i + 1] = out.boost.m[i + 1][0] = -gamma_beta[i];
+        inverse_boost.m[0][i + 1] = inverse_boost.m[i + 1][0] = gamma_beta[i];
+        for (int j = 0; j < 3; j++) {
+            T spatial = (i == j ? 1 : 0) + gamma_beta[i] * gamma_beta[j] / (1 + gamma);
+            out.boost.m[i + 1][j + 1] = inverse_boost.m[i + 1][j + 1] = spatial;
+        }
     }
 
-    // Get Lorentz matrix
-    float* lorentzMatrix = getLorentzMatrix(velocity);
-    if (lorentzMatrix == nullptr) {
-        free(matrices[0]);
-        free(matrices[1]);
-        free(matrices);
-        std::cout << "hiError in getFinalMatrix()" << std::endl;
-        return nullptr; // Handle the case when Lorentz matrix is invalid
+    Mat4T<T> rotation = mat4Multiply(lorentz, inverse_boost);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            out.wigner.m[i][j] = rotation.m[i + 1][j + 1];
+        }
     }
+    out.lorentz = lorentz;
+}
 
-    // Perform the multiplications: A_f = R * A_o * R^T
-    // First, multiply lorentzMatrix * matrices[0] (A_o * R)
-    float* intermediate = matrixMultiply(reinterpret_cast<float(*)[4]>(lorentzMatrix), reinterpret_cast<float(*)[4]>(matrices[0]));
-    if (intermediate == nullptr) {
-        free(lorentzMatrix);
-        free(matrices[0]);
-        free(matrices[1]);
-        free(matrices);
-        std::cout << "byeError in getFinalMatrix()" << std::endl;
-        return nullptr; // Handle multiplication failure
+template<typename T>
+BoostStatus composeBoosts(const T* u, const T* v, BoostCompositionT<T>& out) {
+    Mat4T<T> first, second;
+    BoostStatus status = getBoostMat4(u, first);
+    if (status == BOOST_OK) {
+        status = getBoostMat4(v, second);
     }
+    if (status != BOOST_OK) {
+        return status;
+    }
+    decomposeLorentz(mat4Multiply(second, first), out);
+    return BOOST_OK;
+}
 
-    // Then, multiply matrices[1] * intermediate (R^T * (A_o * R))
-    float* final = matrixMultiply(reinterpret_cast<float(*)[4]>(matrices[1]), reinterpret_cast<float(*)[4]>(intermediate));
-    if (final == nullptr) {
-        free(lorentzMatrix);
-        free(matrices[0]);
-        free(matrices[1]);
-        free(matrices);
-        free(intermediate);
-        std::cout << "rohanError in getFinalMatrix()" << std::endl;
-        return nullptr; // Handle multiplication failure
+template<typename T>
+BoostStatus composeBoost(const BoostCompositionT<T>& current, const T* velocity, BoostCompositionT<T>& out) {
+    Mat4T<T> next;
+    BoostStatus status = getBoostMat4(velocity, next);
+    if (status != BOOST_OK) {
+        return status;
     }
+    decomposeLorentz(mat4Multiply(next, current.lorentz), out);
+    return BOOST_OK;
+}
 
-    // Free memory for intermediate matrices
-    free(lorentzMatrix);
-    free(matrices[0]);
-    free(matrices[1]);
-    free(matrices);
-    free(intermediate);
+template<typename T>
+BoostCacheT<T>::BoostCacheT(T epsilon) : epsilon_(epsilon) {}
 
-    return final; // Return the final matrix A_f
+template<typename T>
+bool BoostCacheT<T>::matches(const Entry& entry, const T* velocity) const {
+    if (epsilon_ == 0) {
+        return entry.velocity[0] == velocity[0] && entry.velocity[1] == velocity[1] && entry.velocity[2] == velocity[2];
+    }
+    return std::fabs(entry.velocity[0] - velocity[0]) <= epsilon_ &&
+           std::fabs(entry.velocity[1] - velocity[1]) <= epsilon_ &&
+           std::fabs(entry.velocity[2] - velocity[2]) <= epsilon_;
 }
 
-// Function to reshape a 1D array into a 2D vector
-std::vector<std::vector<float> > reshapeTo2D(const float* inputArray, int rows, int cols) {
-    std::vector<std::vector<float> > result(rows, std::vector<float>(cols));
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            result[i][j] = inputArray[i * cols + j];
+template<typename T>
+BoostStatus BoostCacheT<T>::get(const T* velocity, Mat4T<T>& out) {
+    if (size_ > 0 && matches(entries_[last_hit_], velocity)) {
+        hits_++;
+        out = entries_[last_hit_].boost;
+        return BOOST_OK;
+    }
+    for (int i = 0; i < size_; i++) {
+        if (matches(entries_[i], velocity)) {
+            hits_++;
+            last_hit_ = i;
+            out = entries_[i].boost;
+            return BOOST_OK;
         }
     }
-    return result;
+
+    misses_++;
+    BoostStatus status = getBoostMat4(velocity, out);
+    if (status != BOOST_OK) {
+        return status;
+    }
+
+    Entry& entry = entries_[next_];
+    entry.velocity[0] = velocity[0];
+    entry.velocity[1] = velocity[1];
+    entry.velocity[2] = velocity[2];
+    entry.boost = out;
+    last_hit_ = next_;
+    next_ = (next_ + 1) % CAPACITY;
+    if (size_ < CAPACITY) {
+        size_++;
+    }
+    return BOOST_OK;
 }
 
-// Transformation function
-std::vector<float> transformation(const float* inputArray, float* velocity, int size_of_input_array) {
-    int cols = 4; // Fixed column size
-    int rows = size_of_input_array / cols;
-    //int size = sizeof(inputArray) / sizeof(inputArray[0]);
+template<typename T>
+void BoostCacheT<T>::clear() {
+    size_ = 0;
+    next_ = 0;
+    last_hit_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+}
 
-    // Reshape into 2D array
-    std::vector<std::vector<float> > reshapedArray = reshapeTo2D(inputArray, rows, cols);
+template<typename T>
+BoostCacheT<T>& transformationCache() {
+    static thread_local BoostCacheT<T> cache;
+    return cache;
+}
 
+// Transformation function: boosts straight from inputArray into outputArray, no intermediate containers
+template<typename T>
+BoostStatus transformation(const T* inputArray, T* outputArray, const T* velocity, int size_of_input_array) {
     // Get the final transformation matrix
-    float* finalMatrix = getFinalMatrix(velocity);
-    if (finalMatrix == nullptr) {
-        std::cerr << "Error: Failed to get the final transformation matrix." << std::endl;
+    Mat4T<T> finalMatrix;
+    BoostStatus status = transformationCache<T>().get(velocity, finalMatrix);
+    if (status != BOOST_OK) {
+        return status;
     }
 
-    // 1D vector to store the results
-    std::vector<float> finalResults;
-
-    // Loop through each row of the reshaped array
-    for (int i = 0; i < rows; ++i) {
-        // Convert the current row to a column vector
-        float rowVector[4] = {reshapedArray[i][0], reshapedArray[i][1], reshapedArray[i][2], reshapedArray[i][3]};
-        float* rowResult = matrixVectorMultiply(reinterpret_cast<float(*)[4]>(finalMatrix), reinterpret_cast<float(*)[1]>(&rowVector));
-
-        // Check for multiplication success
-        if (rowResult == nullptr) {
-            std::cerr << "Error: Failed to multiply matrix with row vector " << i << "." << std::endl;
-            free(finalMatrix);
-        }
+    boostEventsAxis(boostAxis(velocity), finalMatrix, inputArray, outputArray, size_of_input_array / 4);
+    return BOOST_OK;
+}
 
-        // Append results to the final 1D array
-        for (int j = 0; j < 4; ++j) {
-            finalResults.push_back(rowResult[j]);
-        }
+template<typename T>
+void transformation(const T* inputArray, T* outputArray, const RapidityT<T>& rapidity, int size_of_input_array) {
+    Mat4T<T> finalMatrix;
+    getBoostMat4(rapidity, finalMatrix);
+    boostEventsAxis(boostAxis(rapidity.direction), finalMatrix, inputArray, outputArray, size_of_input_array / 4);
+}
 
-        // Free the memory allocated for the row result
-        free(rowResult);
+template<typename T>
+std::vector<T> transformation(const T* inputArray, const T* velocity, int size_of_input_array) {
+    std::vector<T> finalResults(size_of_input_array / 4 * 4);
+    BoostStatus status = transformation(inputArray, finalResults.data(), velocity, size_of_input_array);
+    if (status != BOOST_OK) {
+        LOG_ERROR("transformation: failed to get the final transformation matrix, " << boostStatusMessage(status));
+        return {};
     }
-    for (float val : finalResults) {
-        //std::cout << val << " ";
-    }
-    std::cout << std::endl;
-    /*float* resultant_events = new float[finalResults.size()];
-    std::copy(finalResults.begin(), finalResults.end(), resultant_events);
-    return resultant_events; */
     return finalResults;
+}
 
+// Transformation with the boost built from a rapidity, for ultra-relativistic observers
+template<typename T>
+std::vector<T> transformation(const T* inputArray, const RapidityT<T>& rapidity, int size_of_input_array) {
+    std::vector<T> finalResults(size_of_input_array / 4 * 4);
+    transformation(inputArray, finalResults.data(), rapidity, size_of_input_array);
+    return finalResults;
 }
+
+// Explicit instantiations: float is the default pipeline, double is for long or high-gamma sessions
+#define INSTANTIATE_MATRIX_OPERATIONS(T) \
+    template BoostStatus getLorentzMat4<T>(const T*, Mat4T<T>&); \
+    template void getRotMat4s<T>(const T*, Mat4T<T>&, Mat4T<T>&); \
+    template void getRotMat4sRodrigues<T>(const T*, Mat4T<T>&, Mat4T<T>&); \
+    template BoostStatus getFinalMat4<T>(const T*, Mat4T<T>&); \
+    template BoostStatus getBoostMat4<T>(const T*, Mat4T<T>&); \
+    template BoostStatus rapidityFromVelocity<T>(const T*, RapidityT<T>&); \
+    template RapidityT<T> rapidityFromGamma<T>(T, const T*); \
+    template RapidityT<T> addCollinearRapidity<T>(const RapidityT<T>&, T); \
+    template void rapidityToVelocity<T>(const RapidityT<T>&, T*); \
+    template void getBoostMat4<T>(const RapidityT<T>&, Mat4T<T>&); \
+    template void addVelocities<T>(const T*, const T*, T*); \
+    template void decomposeLorentz<T>(const Mat4T<T>&, BoostCompositionT<T>&); \
+    template BoostStatus composeBoosts<T>(const T*, const T*, BoostCompositionT<T>&); \
+    template BoostStatus composeBoost<T>(const BoostCompositionT<T>&, const T*, BoostCompositionT<T>&); \
+    template class BoostCacheT<T>; \
+    template BoostCacheT<T>& transformationCache<T>(); \
+    template std::vector<T> transformation<T>(const T*, const T*, int); \
+    template std::vector<T> transformation<T>(const T*, const RapidityT<T>&, int); \
+    template BoostStatus transformation<T>(const T*, T*, const T*, int); \
+    template void transformation<T>(const T*, T*, const RapidityT<T>&, int);
+
+INSTANTIATE_MATRIX_OPERATIONS(float)
+INSTANTIATE_MATRIX_OPERATIONS(double)
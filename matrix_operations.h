@@ -1,18 +1,313 @@
 #include <cstdlib>
 #include <iostream>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 #ifndef MATRIX_OPERATIONS_H
 #define MATRIX_OPERATIONS_H
 
+// Fixed-size value types. They live on the stack, so nothing on the boost path
+// has to malloc. Index 0 is t, then x, y, z. T is float or double.
+template<typename T>
+struct alignas(16) Vec4T {
+    T v[4];
+
+    constexpr T& operator[](int i) { return v[i]; }
+    constexpr const T& operator[](int i) const { return v[i]; }
+};
+
+template<typename T>
+struct Mat3T {
+    T m[3][3];
+};
+
+template<typename T>
+struct alignas(16) Mat4T {
+    T m[4][4];
+
+    // Row-major, so this is layout compatible with the old float[16] buffers
+    constexpr T* data() { return &m[0][0]; }
+    constexpr const T* data() const { return &m[0][0]; }
+};
+
+using Vec4 = Vec4T<float>;
+using Mat3 = Mat3T<float>;
+using Mat4 = Mat4T<float>;
+using Vec4d = Vec4T<double>;
+using Mat3d = Mat3T<double>;
+using Mat4d = Mat4T<double>;
+
+template<typename T = float>
+constexpr Mat3T<T> identityMat3() {
+    Mat3T<T> result{};
+    for (int i = 0; i < 3; i++) {
+        result.m[i][i] = 1;
+    }
+    return result;
+}
+
+template<typename T = float>
+constexpr Mat4T<T> identityMat4() {
+    Mat4T<T> result{};
+    for (int i = 0; i < 4; i++) {
+        result.m[i][i] = 1;
+    }
+    return result;
+}
+
+template<typename T>
+constexpr Mat3T<T> mat3Multiply(const Mat3T<T>& a, const Mat3T<T>& b) {
+    Mat3T<T> result{};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++) {
+                result.m[i][j] += a.m[i][k] * b.m[k][j];
+            }
+        }
+    }
+    return result;
+}
+
+template<typename T>
+constexpr Mat4T<T> mat4Multiply(const Mat4T<T>& a, const Mat4T<T>& b) {
+    Mat4T<T> result{};
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            for (int k = 0; k < 4; k++) {
+                result.m[i][j] += a.m[i][k] * b.m[k][j];
+            }
+        }
+    }
+    return result;
+}
+
+template<typename T>
+constexpr Vec4T<T> mat4VectorMultiply(const Mat4T<T>& a, const Vec4T<T>& b) {
+    Vec4T<T> result{};
+    for (int i = 0; i < 4; i++) {
+        for (int k = 0; k < 4; k++) {
+            result[i] += a.m[i][k] * b[k];
+        }
+    }
+    return result;
+}
+
+template<typename T>
+constexpr Mat4T<T> transposeMat4(const Mat4T<T>& a) {
+    Mat4T<T> result{};
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.m[i][j] = a.m[j][i];
+        }
+    }
+    return result;
+}
+
+// Square root usable in constant expressions (std::sqrt is not constexpr in C++17).
+// Newton's iteration from above the root stops decreasing once it has converged; it runs
+// in long double and rounds once, which matches std::sqrt for float and is within an ulp
+// for double. NaN for negative x.
+template<typename T>
+constexpr T constexprSqrt(T x) {
+    if (!(x >= 0)) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+    if (x == 0 || x == std::numeric_limits<T>::infinity()) {
+        return x;
+    }
+    long double wide = x;
+    long double current = wide > 1 ? wide : 1;
+    long double next = (current + wide / current) / 2;
+    while (next < current) {
+        current = next;
+        next = (current + wide / current) / 2;
+    }
+    return (T)current;
+}
+
+// Compile-time counterpart of getBoostMat4, for scenarios with a fixed velocity:
+//   constexpr Mat4 observer_boost = boostMat4(0.57f, 0.0f, 0.0f);
+// gamma and every entry fold to constants. At or above c it returns an all-zero matrix,
+// so static_assert(observer_boost.m[0][0] >= 1) rejects the scenario at build time.
+template<typename T>
+constexpr Mat4T<T> boostMat4(T vx, T vy, T vz) {
+    Mat4T<T> result{};
+    T velocity[3] = {vx, vy, vz};
+    T beta_squared = vx * vx + vy * vy + vz * vz;
+    if (!(beta_squared < 1)) {
+        return result;
+    }
+    T gamma = 1 / constexprSqrt(1 - beta_squared);
+    T k = gamma * gamma / (1 + gamma);
+
+    result.m[0][0] = gamma;
+    for (int i = 0; i < 3; i++) {
+        result.m[0][i + 1] = -gamma * velocity[i];
+        result.m[i + 1][0] = -gamma * velocity[i];
+        for (int j = 0; j < 3; j++) {
+            result.m[i + 1][j + 1] = (i == j ? 1 : 0) + k * velocity[i] * velocity[j];
+        }
+    }
+    return result;
+}
+
+// Coordinate axis (1 = x, 2 = y, 3 = z) a velocity or rapidity direction lies along, 0 if
+// it has no or several nonzero components. getBoostMat4 then only mixes t with that axis.
+template<typename T>
+constexpr int boostAxis(const T* velocity) {
+    int axis = 0;
+    for (int i = 0; i < 3; i++) {
+        if (velocity[i] != 0) {
+            if (axis != 0) {
+                return 0;
+            }
+            axis = i + 1;
+        }
+    }
+    return axis;
+}
+
+// The same for a matrix: the axis if boost leaves the other two coordinates alone and
+// keeps them out of t and the axis, else 0
+template<typename T>
+constexpr int boostAxis(const Mat4T<T>& boost) {
+    for (int axis = 1; axis <= 3; axis++) {
+        bool aligned = true;
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                bool mixed = (i == 0 || i == axis) && (j == 0 || j == axis);
+                if (!mixed && boost.m[i][j] != (i == j ? 1 : 0)) {
+                    aligned = false;
+                }
+            }
+        }
+        if (aligned) {
+            return axis;
+        }
+    }
+    return 0;
+}
+
+// Why a boost could not be built. BOOST_OK is 0, so test with != BOOST_OK.
+typedef enum BoostStatus {
+    BOOST_OK = 0,
+    BOOST_SPEED_NOT_BELOW_C, // |velocity| >= 1
+    BOOST_NOT_FINITE         // NaN or infinite velocity component
+} BoostStatus;
+
+const char* boostStatusMessage(BoostStatus status);
+
+// Value-type builders. They return a status where the pointer versions return nullptr,
+// and never print, so they are safe on the per-frame path.
+// Defined in matrix_operations.cpp for float and double.
+template<typename T> BoostStatus getLorentzMat4(const T* velocity, Mat4T<T>& out);
+template<typename T> void getRotMat4s(const T* velocity, Mat4T<T>& rot, Mat4T<T>& inverseRot);
+template<typename T> void getRotMat4sRodrigues(const T* velocity, Mat4T<T>& rot, Mat4T<T>& inverseRot);
+template<typename T> BoostStatus getFinalMat4(const T* velocity, Mat4T<T>& out);
+template<typename T> BoostStatus getBoostMat4(const T* velocity, Mat4T<T>& out); // same matrix as getFinalMat4, built directly
+
+// Velocity stored as rapidity: eta = atanh(|beta|) along a unit direction.
+// gamma = cosh(eta) and gamma * beta = sinh(eta) are built directly, so the boost stays
+// accurate for gamma in the 1e3-1e6 range where 1 / sqrt(1 - beta^2) cancels in float.
+// Rapidities along the same direction simply add.
+template<typename T>
+struct RapidityT {
+    T eta;          // >= 0
+    T direction[3]; // unit vector, all zero at rest
+};
+
+using Rapidity = RapidityT<float>;
+using Rapidityd = RapidityT<double>;
+
+template<typename T> BoostStatus rapidityFromVelocity(const T* velocity, RapidityT<T>& out);
+template<typename T> RapidityT<T> rapidityFromGamma(T gamma, const T* direction);
+template<typename T> RapidityT<T> addCollinearRapidity(const RapidityT<T>& rapidity, T eta); // eta along rapidity's direction, may be negative
+template<typename T> void rapidityToVelocity(const RapidityT<T>& rapidity, T* velocity);
+template<typename T> void getBoostMat4(const RapidityT<T>& rapidity, Mat4T<T>& out);
+
+// A general (proper, orthochronous) Lorentz transform split as lorentz = wigner * boost.
+// Composing two boosts gives a boost to u (+) v followed by a Thomas-Wigner rotation.
+template<typename T>
+struct BoostCompositionT {
+    T velocity[3];    // velocity of the pure boost part
+    Mat3T<T> wigner;  // Thomas-Wigner rotation, identity for collinear velocities
+    Mat4T<T> boost;   // pure boost for velocity
+    Mat4T<T> lorentz; // the full transform
+};
+
+using BoostComposition = BoostCompositionT<float>;
+
+// Relativistic velocity addition: velocity in the lab of something moving at v
+// in a frame that itself moves at u. Not commutative for non-parallel u, v.
+template<typename T> void addVelocities(const T* u, const T* v, T* out);
+// Splits lorentz into wigner * boost
+template<typename T> void decomposeLorentz(const Mat4T<T>& lorentz, BoostCompositionT<T>& out);
+// boost(v) * boost(u): lab -> frame moving at u -> frame moving at v relative to that
+template<typename T> BoostStatus composeBoosts(const T* u, const T* v, BoostCompositionT<T>& out);
+// Applies one more boost to an existing transform, so an observer or block whose
+// velocity changes by velocity (in its own frame) updates without a rebuild from raw velocities
+template<typename T> BoostStatus composeBoost(const BoostCompositionT<T>& current, const T* velocity, BoostCompositionT<T>& out);
+
+// Old pointer API, kept as thin wrappers over the value types. Results are malloc'd.
 float* matrixVectorMultiply(float mat1[][4], float mat2[][1]);
 float* matrixMultiply(float mat1[][4], float mat2[][4]);
 float* newMatrixMultiply(float mat1[][3], float mat2[][3]);
 float* getLorentzMatrix(const float* velocity);
 float** getRotMatrices(const float* velocity);
 float* getFinalMatrix(float* velocity);
+float* getBoostMatrix(float* velocity);
+
+// Small velocity-keyed cache of boost matrices, so repeated transforms under the
+// same observer skip matrix construction. A velocity hits if every component is
+// within epsilon of a cached one (epsilon 0 means exact match). Not thread safe.
+template<typename T>
+class BoostCacheT {
+public:
+    explicit BoostCacheT(T epsilon = 0);
+
+    BoostStatus get(const T* velocity, Mat4T<T>& out);
+    void clear();
+
+    void setEpsilon(T epsilon) { epsilon_ = epsilon; }
+    T epsilon() const { return epsilon_; }
+    unsigned long long hits() const { return hits_; }
+    unsigned long long misses() const { return misses_; }
+
+private:
+    static const int CAPACITY = 8;
+
+    struct Entry {
+        T velocity[3];
+        Mat4T<T> boost;
+    };
+
+    bool matches(const Entry& entry, const T* velocity) const;
+
+    Entry entries_[CAPACITY];
+    int size_ = 0;
+    int next_ = 0;     // slot the next miss overwrites
+    int last_hit_ = 0; // checked first, since one velocity usually repeats
+    T epsilon_;
+    unsigned long long hits_ = 0;
+    unsigned long long misses_ = 0;
+};
+
+using BoostCache = BoostCacheT<float>;
+
+// The cache transformation() uses. One per thread and scalar type.
+template<typename T = float> BoostCacheT<T>& transformationCache();
 
-std::vector<float> transformation(const float* inputArray, float* velocity, int size_of_input_array);
+// Boosts size_of_input_array / 4 packed (t,x,y,z) events into the observer frame
+template<typename T>
+std::vector<T> transformation(const T* inputArray, const T* velocity, int size_of_input_array);
+template<typename T>
+std::vector<T> transformation(const T* inputArray, const RapidityT<T>& rapidity, int size_of_input_array);
+// Same, written into a caller-provided buffer of size_of_input_array / 4 * 4 values.
+// outputArray may be inputArray to boost in place.
+template<typename T>
+BoostStatus transformation(const T* inputArray, T* outputArray, const T* velocity, int size_of_input_array);
+template<typename T>
+void transformation(const T* inputArray, T* outputArray, const RapidityT<T>& rapidity, int size_of_input_array);
 
-#endif
\ No newline at end of file
+#endif
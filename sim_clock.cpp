@@ -0,0 +1,21 @@
+#include "sim_clock.h"
+#include <algorithm>
+#include <cmath>
+
+SimClock::SimClock(int steps_per_second, int max_steps_per_advance)
+    : steps_per_second_(std::max(steps_per_second, 1)), step_(1.0 / steps_per_second_),
+      max_steps_(std::max(max_steps_per_advance, 1)) {
+}
+
+int SimClock::advance(double real_seconds) {
+    if (real_seconds > 0) {
+        accumulator_ += real_seconds;
+    }
+    int due = (int)std::min(accumulator_ / step_, (double)max_steps_);
+    accumulator_ -= due * step_;
+    if (due == max_steps_ && accumulator_ >= step_) {
+        dropped_ += accumulator_ - std::fmod(accumulator_, step_);
+        accumulator_ = std::fmod(accumulator_, step_);
+    }
+    return due;
+}
@@ -0,0 +1,37 @@
+#include <cstdint>
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+// Fixed-timestep simulation clock. Real frame time goes into an accumulator and comes out
+// as whole steps of 1/steps_per_second, so motion and capture see the same step sequence
+// whatever the render rate, and sim time is step count * step: a run is reproducible bit
+// for bit. With no window to pace it, call tick() in a loop to run faster than real time.
+//   for (int due = clock.advance(GetFrameTime()); due > 0; due--) { clock.tick(); simulate(clock.step()); }
+class SimClock {
+public:
+    // max_steps_per_advance bounds the catch-up after a stall; the rest of the backlog is dropped
+    explicit SimClock(int steps_per_second = 240, int max_steps_per_advance = 64);
+
+    // Adds real_seconds of wall time and returns how many steps are now due
+    int advance(double real_seconds);
+    // Runs one step: time() moves on by step()
+    void tick() { steps_++; }
+
+    double time() const { return steps_ * step_; }  // sim seconds after the last tick()
+    double step() const { return step_; }
+    uint64_t steps() const { return steps_; }
+    int stepsPerSecond() const { return steps_per_second_; }
+    double alpha() const { return accumulator_ / step_; } // fraction of a step still pending, for interpolating the render
+    double droppedSeconds() const { return dropped_; }   // wall time discarded by the catch-up bound
+
+private:
+    int steps_per_second_;
+    double step_;
+    int max_steps_;
+    uint64_t steps_ = 0;
+    double accumulator_ = 0;
+    double dropped_ = 0;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "worker_pool.h"
+#include <algorithm>
+
+WorkerPool& WorkerPool::instance() {
+    static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+WorkerPool::WorkerPool(unsigned workers) {
+    for (unsigned w = 0; w < workers; w++) {
+        workers_.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+// Runs parts until none are left unclaimed. Called with mutex_ held, returns with it held.
+void WorkerPool::claimParts() {
+    std::unique_lock<std::mutex> lock(mutex_, std::adopt_lock);
+    while (next_part_ < parts_) {
+        size_t part = next_part_++;
+        lock.unlock();
+        (*job_)(part);
+        lock.lock();
+        if (++parts_done_ == parts_) {
+            done_.notify_one();
+        }
+    }
+    lock.release();
+}
+
+void WorkerPool::work() {
+    unsigned long long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+            return;
+        }
+        seen = generation_;
+        claimParts();
+    }
+}
+
+void WorkerPool::run(size_t parts, const std::function<void(size_t)>& job) {
+    if (parts <= 1 || workers_.empty()) {
+        for (size_t part = 0; part < parts; part++) {
+            job(part);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> running(run_mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = &job;
+    parts_ = parts;
+    next_part_ = 0;
+    parts_done_ = 0;
+    generation_++;
+    wake_.notify_all();
+    claimParts();
+    done_.wait(lock, [&] { return parts_done_ == parts_; });
+    job_ = nullptr;
+}
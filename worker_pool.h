@@ -0,0 +1,48 @@
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+// Worker threads started once and kept for the life of the program, so a post-capture
+// stage split across cores pays a wake-up per worker (a few microseconds) rather than a
+// thread spawn and join (15-35 us measured) on every call. Parts are claimed in any order
+// but each runs exactly once, so a job whose part p always covers the same range gives the
+// same output however it was scheduled.
+class WorkerPool {
+public:
+    // hardware_concurrency - 1 workers: the thread calling run() is the last core
+    static WorkerPool& instance();
+
+    explicit WorkerPool(unsigned workers);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // job(part) for every part in [0, parts), the caller working alongside the workers;
+    // returns once all are done. One job at a time: concurrent callers take turns.
+    void run(size_t parts, const std::function<void(size_t)>& job);
+    unsigned threads() const { return (unsigned)workers_.size() + 1; } // workers plus the caller
+
+private:
+    void work();
+    void claimParts();
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;  // held for a whole run()
+    std::mutex mutex_;      // guards everything below
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t parts_ = 0;
+    size_t next_part_ = 0;
+    size_t parts_done_ = 0;
+    unsigned long long generation_ = 0; // bumped per run(), so a worker takes each job once
+    bool stop_ = false;
+};
+
+#endif
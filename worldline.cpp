@@ -0,0 +1,150 @@
+#include "worldline.h"
+#include "boost_kernels.h"
+#include "event_pipeline.h"
+#include <algorithm>
+#include <cmath>
+
+template<typename T>
+WorldlinesT<T>::WorldlinesT(T tolerance) : tolerance_(tolerance) {
+}
+
+template<typename T>
+uint32_t WorldlinesT<T>::addBlock(const T* body_offsets, int corner_count) {
+    Block block;
+    block.body.assign(body_offsets, body_offsets + corner_count * 3);
+    blocks_.push_back(std::move(block));
+    return (uint32_t)(blocks_.size() - 1);
+}
+
+template<typename T>
+bool WorldlinesT<T>::record(uint32_t block, T t, const T* position, const T* velocity) {
+    if (block >= blocks_.size()) {
+        return false;
+    }
+    Block& b = blocks_[block];
+    if (!b.segments.empty()) {
+        WorldlineSegmentT<T>& segment = b.segments.back();
+        T elapsed = t - segment.start[0];
+        bool on_line = true;
+        for (int i = 0; i < 3; i++) {
+            on_line = on_line && segment.velocity[i] == velocity[i]
+                      && std::fabs(segment.start[i + 1] + segment.velocity[i] * elapsed - position[i]) <= tolerance_;
+        }
+        if (on_line) {
+            segment.end = t;
+            return false;
+        }
+    }
+
+    WorldlineSegmentT<T> segment;
+    segment.start[0] = t;
+    std::copy(position, position + 3, segment.start + 1);
+    std::copy(velocity, velocity + 3, segment.velocity);
+    segment.end = t;
+    segment.offsets = b.body;
+    b.segments.push_back(std::move(segment));
+    return true;
+}
+
+template<typename T>
+BoostStatus WorldlinesT<T>::observe(const T* observer_velocity, WorldlinesT& out) const {
+    out.blocks_.resize(blocks_.size());
+    out.tolerance_ = tolerance_;
+    RigidBlockT<T> rigid;
+    for (size_t b = 0; b < blocks_.size(); b++) {
+        const Block& lab = blocks_[b];
+        Block& observed = out.blocks_[b];
+        observed.body = lab.body;
+        observed.segments.resize(lab.segments.size());
+        int corner_count = (int)(lab.body.size() / 3);
+        for (size_t s = 0; s < lab.segments.size(); s++) {
+            const WorldlineSegmentT<T>& segment = lab.segments[s];
+            BoostStatus status = makeRigidBlock(observer_velocity, segment.velocity, lab.body.data(), corner_count, rigid);
+            if (status != BOOST_OK) {
+                return status;
+            }
+            // Its first and last center events, boosted together
+            T duration = segment.end - segment.start[0];
+            T ends[8] = {segment.start[0], segment.start[1], segment.start[2], segment.start[3], segment.end,
+                         segment.start[1] + segment.velocity[0] * duration,
+                         segment.start[2] + segment.velocity[1] * duration,
+                         segment.start[3] + segment.velocity[2] * duration};
+            boostEvents(rigid.boost, ends, ends, 2);
+
+            WorldlineSegmentT<T>& seen = observed.segments[s];
+            std::copy(ends, ends + 4, seen.start);
+            std::copy(rigid.velocity, rigid.velocity + 3, seen.velocity);
+            seen.end = ends[4];
+            seen.offsets = rigid.offsets;
+        }
+    }
+    return BOOST_OK;
+}
+
+// t grows along a worldline in any frame, so the segments stay sorted by start time
+template<typename T>
+bool WorldlinesT<T>::sample(uint32_t block, T t, T* events) const {
+    if (block >= blocks_.size()) {
+        return false;
+    }
+    const std::vector<WorldlineSegmentT<T>>& segments = blocks_[block].segments;
+    if (segments.empty() || !(t >= segments.front().start[0] && t <= segments.back().end)) {
+        return false;
+    }
+    auto after = std::upper_bound(segments.begin(), segments.end(), t,
+                                  [](T time, const WorldlineSegmentT<T>& segment) { return time < segment.start[0]; });
+    const WorldlineSegmentT<T>& segment = *(after - 1);
+
+    T elapsed = t - segment.start[0];
+    T center[3];
+    for (int i = 0; i < 3; i++) {
+        center[i] = segment.start[i + 1] + segment.velocity[i] * elapsed;
+    }
+    size_t corner_count = segment.offsets.size() / 3;
+    for (size_t k = 0; k <= corner_count; k++) {
+        events[k * 4] = t;
+        for (int i = 0; i < 3; i++) {
+            events[k * 4 + 1 + i] = center[i] + (k == 0 ? 0 : segment.offsets[(k - 1) * 3 + i]);
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void WorldlinesT<T>::sampleFrames(uint32_t block, T step, std::vector<std::vector<T>>& frames) const {
+    frames.clear();
+    if (block >= blocks_.size() || blocks_[block].segments.empty() || !(step > 0)) {
+        return;
+    }
+    const std::vector<WorldlineSegmentT<T>>& segments = blocks_[block].segments;
+    T first = segments.front().start[0];
+    size_t count = (size_t)std::floor((segments.back().end - first) / step) + 1;
+    frames.resize(count, std::vector<T>((corners(block) + 1) * 4));
+    for (size_t f = 0; f < count; f++) {
+        sample(block, std::min(first + (T)f * step, segments.back().end), frames[f].data());
+    }
+}
+
+template<typename T>
+size_t WorldlinesT<T>::segments() const {
+    size_t count = 0;
+    for (const Block& block : blocks_) {
+        count += block.segments.size();
+    }
+    return count;
+}
+
+template<typename T>
+size_t WorldlinesT<T>::bytes() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.body.capacity() * sizeof(T) + block.segments.capacity() * sizeof(WorldlineSegmentT<T>);
+        for (const WorldlineSegmentT<T>& segment : block.segments) {
+            total += segment.offsets.capacity() * sizeof(T);
+        }
+    }
+    return total;
+}
+
+template class WorldlinesT<float>;
+template class WorldlinesT<double>;
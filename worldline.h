@@ -0,0 +1,69 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "matrix_operations.h"
+
+#ifndef WORLDLINE_H
+#define WORLDLINE_H
+
+// Parametric capture: each block is a rigid body whose center moves in straight lines
+// between velocity changes, so instead of sampling every corner every frame its worldline
+// is kept as piecewise-linear segments, and events are generated on demand at any time
+// and resolution. Storage and transform cost scale with the number of velocity changes.
+// Observing the worldlines boosts each segment once, with the rigid-body shape from
+// makeRigidBlock; near a velocity change the corners follow the center's segment.
+// Defined in worldline.cpp for float and double.
+
+template<typename T>
+struct WorldlineSegmentT {
+    T start[4];             // center event (t, x, y, z) the segment starts at
+    T velocity[3];          // center velocity along the segment
+    T end;                  // time of the last record() on it; sample() carries it on to the next segment's start
+    std::vector<T> offsets; // each corner's offset from the center at equal time, 3 values per corner
+};
+
+template<typename T>
+class WorldlinesT {
+public:
+    // A recorded center further than tolerance (on any axis) from its segment's line starts
+    // a new segment, so accumulated frame-step rounding does not
+    explicit WorldlinesT(T tolerance = T(1e-3));
+
+    // body_offsets: the corners' lab offsets from the center, 3 values each. Returns the block id.
+    uint32_t addBlock(const T* body_offsets, int corner_count);
+    // The block's center at lab time t (not before its previous record). Extends the current
+    // segment, or starts a new one when velocity changed or the center left the line.
+    // True if a segment was started; false for an unknown block too.
+    bool record(uint32_t block, T t, const T* position, const T* velocity);
+
+    // The same worldlines as seen by an observer: every segment's start and end boosted, its
+    // velocity the observed one and its offsets the contracted, sheared shape. All times in
+    // out are observer times.
+    BoostStatus observe(const T* observer_velocity, WorldlinesT& out) const;
+
+    // Center, then every corner, as (t,x,y,z) events all at time t: (1 + corners) * 4 values,
+    // the frame layout insert_t gives without its trailing t. False outside the recording.
+    bool sample(uint32_t block, T t, T* events) const;
+    // The block every step from its first to its last recorded time, one frame per step,
+    // in the layout processEvents and transformFrames take
+    void sampleFrames(uint32_t block, T step, std::vector<std::vector<T>>& frames) const;
+
+    size_t blocks() const { return blocks_.size(); }
+    size_t corners(uint32_t block) const { return blocks_[block].body.size() / 3; }
+    const std::vector<WorldlineSegmentT<T>>& segments(uint32_t block) const { return blocks_[block].segments; }
+    size_t segments() const; // over all blocks
+    size_t bytes() const;    // segment storage, reserved space included
+
+private:
+    struct Block {
+        std::vector<T> body;
+        std::vector<WorldlineSegmentT<T>> segments;
+    };
+
+    std::vector<Block> blocks_;
+    T tolerance_;
+};
+
+using Worldlines = WorldlinesT<float>;
+
+#endif